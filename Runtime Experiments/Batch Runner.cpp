@@ -0,0 +1,1438 @@
+// Multithreaded batch runner for the Norvig solver (taken from "Norvig Solver.cpp", originally from the
+// Github repository https://github.com/daochenw/sudoku), together with an estimator of the size of the
+// search tree the solver will build for a puzzle.
+//
+// The estimator is Knuth's random-probe method: a probe walks from the root of the search tree to a leaf, choosing
+// the branching cell exactly as the solver does and propagating each candidate with the solver's own assign(), then
+// following one consistent child at random. If the nodes on the probe had d1, d2, ... consistent children, the tree is
+// estimated to have 1 + d1 + d1*d2 + ... nodes. Averaging a few probes gives an unbiased estimate of the size of the
+// full tree, and the time per node measured during the probes turns that into a predicted solve time.
+//
+// Compile with: g++ -O2 -pthread -o batch "Batch Runner.cpp" -lz
+//
+// Usage:
+//   ./batch estimate [probes]                      compares predictions with actual solves on all four difficulty files.
+//   ./batch run <file> [threads] [options] [output]
+//                                                  solves every puzzle in the file. Options are a comma-separated
+//                                                  list of a dispatch order, file-order (default) or the name of a
+//                                                  difficulty predictor, givens, candidates, techniques or probes
+//                                                  (also longest-first), to dispatch in order of decreasing predicted
+//                                                  time (see Predictor), a schedule, static,
+//                                                  dynamic (default) or adaptive (see Schedule), and promote, to
+//                                                  let idle workers join slow solves at the end of the batch (see
+//                                                  solve_batch). Times are always output in the order of the file.
+//                                                  Results are also written to the output file if one is given,
+//                                                  compressed if its name ends in ".sdz".
+//                                                  The distribution of solve times is written to
+//                                                  "Batch Solve Times.hlog", tagged with the file name.
+//   ./batch schedules <file> [threads]             compares the makespan and scheduling cost of each schedule,
+//                                                  without and with straggler promotion.
+//   ./batch predictors <file> [threads]            compares the cost and accuracy of each predictor, and the makespan
+//                                                  of dispatching longest-predicted-first by it, on a file that ideally
+//                                                  mixes difficulties (e.g. the four files concatenated).
+//   ./batch read <results> [frame]                 decompresses a ".sdz" result file, or only one of its frames.
+//   ./batch merge <logs...>                        merges the histograms with the same tag across HdrHistogram
+//                                                  logs (for example from runs in separate processes) and reports
+//                                                  their percentiles.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <numeric>
+#include <cstring>
+#include <cstdint>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <zlib.h>
+using namespace std;
+
+class Possible {
+   vector<bool> _b;
+public:
+   Possible() : _b(9, true) {}
+   bool   is_on(int i) const { return _b[i-1]; }
+   int    count()      const { return std::count(_b.begin(), _b.end(), true); }
+   void   eliminate(int i)   { _b[i-1] = false; }
+   int    val()        const {
+      auto it = find(_b.begin(), _b.end(), true);
+      return (it != _b.end() ? 1 + (it - _b.begin()) : -1);
+   }
+};
+
+class Sudoku {
+   vector<Possible> _cells;
+   static vector< vector<int> > _group, _neighbors, _groups_of;
+
+   bool     eliminate(int k, int val);
+public:
+   Sudoku(string s);
+   static void init();
+
+   Possible possible(int k) const { return _cells[k]; }
+   bool     is_solved() const;
+   bool     assign(int k, int val);
+   int      least_count() const;
+};
+
+bool Sudoku::is_solved() const {
+   for (int k = 0; k < _cells.size(); k++) {
+      if (_cells[k].count() != 1) {
+         return false;
+      }
+   }
+   return true;
+}
+
+vector< vector<int> >
+Sudoku::_group(27), Sudoku::_neighbors(81), Sudoku::_groups_of(81);
+
+void Sudoku::init() {
+   for (int i = 0; i < 9; i++) {
+      for (int j = 0; j < 9; j++) {
+         const int k = i*9 + j;
+         const int x[3] = {i, 9 + j, 18 + (i/3)*3 + j/3};
+         for (int g = 0; g < 3; g++) {
+            _group[x[g]].push_back(k);
+            _groups_of[k].push_back(x[g]);
+         }
+      }
+   }
+   for (int k = 0; k < _neighbors.size(); k++) {
+      for (int x = 0; x < _groups_of[k].size(); x++) {
+         for (int j = 0; j < 9; j++) {
+            int k2 = _group[_groups_of[k][x]][j];
+            if (k2 != k) _neighbors[k].push_back(k2);
+         }
+      }
+   }
+}
+
+bool Sudoku::assign(int k, int val) {
+   for (int i = 1; i <= 9; i++) {
+      if (i != val) {
+         if (!eliminate(k, i)) return false;
+      }
+   }
+   return true;
+}
+
+bool Sudoku::eliminate(int k, int val) {
+   if (!_cells[k].is_on(val)) {
+      return true;
+   }
+   _cells[k].eliminate(val);
+   const int N = _cells[k].count();
+   if (N == 0) {
+      return false;
+   } else if (N == 1) {
+      const int v = _cells[k].val();
+      for (int i = 0; i < _neighbors[k].size(); i++) {
+         if (!eliminate(_neighbors[k][i], v)) return false;
+      }
+   }
+   for (int i = 0; i < _groups_of[k].size(); i++) {
+      const int x = _groups_of[k][i];
+      int n = 0, ks;
+      for (int j = 0; j < 9; j++) {
+         const int p = _group[x][j];
+         if (_cells[p].is_on(val)) {
+            n++, ks = p;
+         }
+      }
+      if (n == 0) {
+         return false;
+      } else if (n == 1) {
+         if (!assign(ks, val)) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+int Sudoku::least_count() const {
+   int k = -1, min;
+   for (int i = 0; i < _cells.size(); i++) {
+      const int m = _cells[i].count();
+      if (m > 1 && (k == -1 || m < min)) {
+         min = m, k = i;
+      }
+   }
+   return k;
+}
+
+Sudoku::Sudoku(string s)
+  : _cells(81)
+{
+   int k = 0;
+   for (int i = 0; i < s.size(); i++) {
+      if (s[i] >= '1' && s[i] <= '9') {
+         if (!assign(k, s[i] - '0')) {
+            cerr << "error" << endl;
+            return;
+         }
+         k++;
+      } else if (s[i] == '0' || s[i] == '.') {
+         k++;
+      }
+   }
+}
+
+// The solver's search, unchanged except that it counts the nodes it visits.
+unique_ptr<Sudoku> solve(unique_ptr<Sudoku> S, long& nodes) {
+   nodes++;
+   if (S == nullptr || S->is_solved()) {
+      return S;
+   }
+   int k = S->least_count();
+   Possible p = S->possible(k);
+   for (int i = 1; i <= 9; i++) {
+      if (p.is_on(i)) {
+         unique_ptr<Sudoku> S1(new Sudoku(*S));
+         if (S1->assign(k, i)) {
+            if (auto S2 = solve(std::move(S1), nodes)) {
+               return S2;
+            }
+         }
+      }
+   }
+   return {};
+}
+
+// ================================ Search Tree Size Estimator ====================================
+
+// Predicted size of the search tree for one puzzle and the time the solver is expected to take.
+struct Estimate {
+   double nodes;
+   double seconds;
+};
+
+// Estimates the size of the search tree with the given number of random probes. The seed makes the
+// estimate reproducible: the same puzzle, probe count and seed always give the same prediction.
+Estimate estimate_tree(const string& puzzle, int probes, unsigned seed) {
+   mt19937 rng(seed);
+   auto start = chrono::steady_clock::now();
+
+   const Sudoku root(puzzle);
+   double total = 0;
+   long expanded = 0;
+
+   for (int probe = 0; probe < probes; probe++) {
+      Sudoku S = root;
+      double weight = 1, size = 1;
+      while (!S.is_solved()) {
+         const int k = S.least_count();
+         const Possible p = S.possible(k);
+         expanded++;
+
+         // Every child the solver would recurse into, i.e. every candidate that survives propagation.
+         vector<Sudoku> children;
+         for (int i = 1; i <= 9; i++) {
+            if (p.is_on(i)) {
+               Sudoku S1 = S;
+               if (S1.assign(k, i)) children.push_back(std::move(S1));
+            }
+         }
+         if (children.empty()) break;
+
+         weight *= children.size();
+         size += weight;
+         S = std::move(children[uniform_int_distribution<size_t>(0, children.size() - 1)(rng)]);
+      }
+      total += size;
+   }
+
+   const double nodes = total / probes;
+   const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+   // The probes expand nodes the same way the solver does, so their average cost per node is used for the prediction.
+   const double per_node = elapsed / max(1L, expanded);
+   return {nodes, nodes * per_node};
+}
+
+// ===================================== HDR Histogram ============================================
+
+// High dynamic range histogram of integer values (here nanoseconds), following the bucket layout of HdrHistogram:
+// values are grouped into buckets covering powers of two, each split into enough linear sub-buckets to keep the
+// given number of significant decimal digits. Recording is a couple of shifts and an increment, so each worker
+// records into its own histogram without locking, and histograms with the same layout are merged by adding counts.
+// Histograms can be written to and read back from the standard HdrHistogram log format, so that histograms
+// from separate processes can be merged as well.
+class HdrHistogram {
+   int64_t _lowest, _highest;
+   int _significant_figures;
+   int _unit_magnitude, _sub_bucket_half_count_magnitude;
+   int64_t _sub_bucket_count, _sub_bucket_half_count, _sub_bucket_mask;
+   int _bucket_count;
+   vector<int64_t> _counts;
+   int64_t _total = 0, _min = INT64_MAX, _max = 0;
+
+   int bucket_index(int64_t v) const {
+      const int pow2ceiling = 64 - __builtin_clzll(v | _sub_bucket_mask);
+      return pow2ceiling - _unit_magnitude - (_sub_bucket_half_count_magnitude + 1);
+   }
+   int sub_bucket_index(int64_t v, int bucket) const { return (int)(v >> (bucket + _unit_magnitude)); }
+   size_t counts_index(int bucket, int sub) const {
+      return ((size_t)(bucket + 1) << _sub_bucket_half_count_magnitude) + (sub - _sub_bucket_half_count);
+   }
+   size_t counts_index_of(int64_t v) const {
+      const int bucket = bucket_index(v);
+      return counts_index(bucket, sub_bucket_index(v, bucket));
+   }
+   int64_t value_at(size_t index) const {
+      int bucket = (int)(index >> _sub_bucket_half_count_magnitude) - 1;
+      int64_t sub = (index & (_sub_bucket_half_count - 1)) + _sub_bucket_half_count;
+      if (bucket < 0) {
+         sub -= _sub_bucket_half_count;
+         bucket = 0;
+      }
+      return sub << (bucket + _unit_magnitude);
+   }
+   // Largest value that would be recorded in the same count as v.
+   int64_t highest_equivalent(int64_t v) const {
+      const int bucket = bucket_index(v);
+      const int sub = sub_bucket_index(v, bucket);
+      const int adjusted = sub >= _sub_bucket_count ? bucket + 1 : bucket;
+      const int64_t lowest = (int64_t)sub << (bucket + _unit_magnitude);
+      return lowest + ((int64_t)1 << (_unit_magnitude + adjusted)) - 1;
+   }
+
+public:
+   HdrHistogram(int64_t lowest, int64_t highest, int significant_figures)
+     : _lowest(lowest), _highest(highest), _significant_figures(significant_figures) {
+      const int64_t largest_single_unit = 2 * (int64_t)pow(10, significant_figures);
+      const int sub_bucket_count_magnitude = (int)ceil(log2((double)largest_single_unit));
+      _sub_bucket_half_count_magnitude = max(sub_bucket_count_magnitude, 1) - 1;
+      _unit_magnitude = (int)floor(log2((double)lowest));
+      _sub_bucket_count = (int64_t)1 << (_sub_bucket_half_count_magnitude + 1);
+      _sub_bucket_half_count = _sub_bucket_count / 2;
+      _sub_bucket_mask = (_sub_bucket_count - 1) << _unit_magnitude;
+
+      int64_t smallest_untrackable = _sub_bucket_count << _unit_magnitude;
+      _bucket_count = 1;
+      while (smallest_untrackable <= highest) {
+         if (smallest_untrackable > INT64_MAX / 2) {
+            _bucket_count++;
+            break;
+         }
+         smallest_untrackable <<= 1;
+         _bucket_count++;
+      }
+      _counts.assign((_bucket_count + 1) * _sub_bucket_half_count, 0);
+   }
+
+   // Histogram of solve times from 1 nanosecond to 1000 seconds to 3 significant digits.
+   static HdrHistogram nanoseconds() { return HdrHistogram(1, 1000000000000LL, 3); }
+
+   // Records a value, clamping it to the trackable range.
+   void record(int64_t v) {
+      v = min(max(v, (int64_t)0), _highest);
+      _counts[counts_index_of(v)]++;
+      _total++;
+      _min = min(_min, v);
+      _max = max(_max, v);
+   }
+
+   // Adds the counts of another histogram with the same layout.
+   void merge(const HdrHistogram& o) {
+      for (size_t i = 0; i < _counts.size(); i++) _counts[i] += o._counts[i];
+      _total += o._total;
+      _min = min(_min, o._min);
+      _max = max(_max, o._max);
+   }
+
+   // Value below which the given percentage of the recorded values fall (to the precision of the histogram).
+   int64_t percentile(double p) const {
+      if (_total == 0) return 0;
+      const int64_t target = max((int64_t)1, (int64_t)(p / 100 * _total + 0.5));
+      int64_t seen = 0;
+      for (size_t i = 0; i < _counts.size(); i++) {
+         seen += _counts[i];
+         if (seen >= target) return min(highest_equivalent(value_at(i)), _max);
+      }
+      return _max;
+   }
+
+   int64_t total() const { return _total; }
+   int64_t max_value() const { return _max; }
+
+   // Encodes the histogram in the compressed V2 format of HdrHistogram and returns it in base64, as used in
+   // histogram logs. The counts up to the largest recorded value are written as ZigZag LEB128 variable-length
+   // integers, with runs of zeros written as a single negative count, after a 40-byte big-endian header.
+   // The whole encoding is then deflated with zlib behind an 8-byte header.
+   string encode() const {
+      vector<uint8_t> payload;
+      const size_t limit = _total ? counts_index_of(_max) + 1 : 0;
+      for (size_t i = 0; i < limit; ) {
+         int64_t value = _counts[i++];
+         if (value == 0) {
+            int64_t zeros = 1;
+            while (i < limit && _counts[i] == 0) zeros++, i++;
+            if (zeros > 1) value = -zeros;
+         }
+         uint64_t z = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+         for (int b = 0; b < 8 && z >= 0x80; b++, z >>= 7) payload.push_back((uint8_t)(z | 0x80));
+         payload.push_back((uint8_t)z);
+      }
+
+      vector<uint8_t> raw;
+      auto put = [&](uint64_t v, int bytes) {
+         for (int b = bytes - 1; b >= 0; b--) raw.push_back((uint8_t)(v >> (8 * b)));
+      };
+      const double ratio = 1.0;
+      uint64_t ratio_bits;
+      memcpy(&ratio_bits, &ratio, 8);
+      put(0x1c849313, 4);              // V2 encoding cookie (with the 0x10 flag for ZigZag LEB128 counts).
+      put(payload.size(), 4);
+      put(0, 4);                       // Normalizing index offset.
+      put(_significant_figures, 4);
+      put(_lowest, 8);
+      put(_highest, 8);
+      put(ratio_bits, 8);              // Integer to double value conversion ratio.
+      raw.insert(raw.end(), payload.begin(), payload.end());
+
+      uLongf compressed_size = compressBound(raw.size());
+      vector<uint8_t> out(8 + compressed_size);
+      compress2(out.data() + 8, &compressed_size, raw.data(), raw.size(), 9);
+      out.resize(8 + compressed_size);
+      const uint32_t header[2] = {0x1c849314, (uint32_t)compressed_size};   // V2 compressed encoding cookie.
+      for (int h = 0; h < 2; h++) {
+         for (int b = 0; b < 4; b++) out[4*h + b] = (uint8_t)(header[h] >> (24 - 8 * b));
+      }
+
+      static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      string base64;
+      for (size_t i = 0; i < out.size(); i += 3) {
+         const uint32_t n = out[i] << 16 | (i + 1 < out.size() ? out[i + 1] << 8 : 0) | (i + 2 < out.size() ? out[i + 2] : 0);
+         base64 += alphabet[n >> 18 & 63];
+         base64 += alphabet[n >> 12 & 63];
+         base64 += i + 1 < out.size() ? alphabet[n >> 6 & 63] : '=';
+         base64 += i + 2 < out.size() ? alphabet[n & 63] : '=';
+      }
+      return base64;
+   }
+
+   // Decodes a histogram written by encode() (or by any HdrHistogram library) and adds its counts to this one.
+   // Returns false if it cannot be decoded or does not have the same layout as this histogram.
+   bool merge_encoded(const string& base64) {
+      vector<uint8_t> in;
+      uint32_t bits = 0;
+      int n = 0;
+      for (char c : base64) {
+         int v;
+         if (c >= 'A' && c <= 'Z') v = c - 'A';
+         else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+         else if (c >= '0' && c <= '9') v = c - '0' + 52;
+         else if (c == '+') v = 62;
+         else if (c == '/') v = 63;
+         else continue;
+         bits = bits << 6 | v;
+         if ((n += 6) >= 8) in.push_back((uint8_t)(bits >> (n -= 8)));
+      }
+      auto get = [](const uint8_t* p, int bytes) {
+         uint64_t v = 0;
+         for (int b = 0; b < bytes; b++) v = v << 8 | p[b];
+         return v;
+      };
+      // The low byte of each cookie carries flags, which are ignored when comparing.
+      if (in.size() < 8 || (get(in.data(), 4) & ~0xF0ULL) != 0x1c849304) return false;
+
+      uLongf raw_size = 40 + 9 * _counts.size();
+      vector<uint8_t> raw(raw_size);
+      if (uncompress(raw.data(), &raw_size, in.data() + 8, in.size() - 8) != Z_OK || raw_size < 40) return false;
+      if ((get(&raw[0], 4) & ~0xF0ULL) != 0x1c849303 || (int)get(&raw[12], 4) != _significant_figures
+          || (int64_t)get(&raw[16], 8) != _lowest || (int64_t)get(&raw[24], 8) != _highest) return false;
+
+      const size_t end = min((size_t)raw_size, (size_t)(40 + get(&raw[4], 4)));
+      size_t index = 0;
+      for (size_t p = 40; p < end && index < _counts.size(); ) {
+         uint64_t z = 0;
+         int shift = 0;
+         for (int b = 0; b < 9 && p < end; b++, shift += 7) {
+            const uint8_t byte = raw[p++];
+            if (b == 8) {
+               z |= (uint64_t)byte << 56;
+               break;
+            }
+            z |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+         }
+         const int64_t value = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+         if (value < 0) {
+            index += -value;
+         } else {
+            if (value > 0) {
+               const int64_t v = value_at(index);
+               _total += value;
+               _min = min(_min, v);
+               _max = max(_max, highest_equivalent(v));
+            }
+            _counts[index++] += value;
+         }
+      }
+      return true;
+   }
+};
+
+// Writes histograms as a standard HdrHistogram log, one tagged interval per histogram. Values are
+// in nanoseconds, and the maximum of each interval is given in seconds.
+void write_histogram_log(const string& path, double start_time, double interval,
+                         const vector<pair<string, const HdrHistogram*> >& histograms) {
+   ofstream o(path);
+   o << "#[Histogram log format version 1.3]\n";
+   o << "#[StartTime: " << fixed << setprecision(3) << start_time << " (seconds since epoch)]\n";
+   o << "#[MaxValueDivisor: 1000000000.000]\n";
+   o << "\"StartTimestamp\",\"Interval_Length\",\"Interval_Max\",\"Interval_Compressed_Histogram\"\n";
+   for (const auto& h : histograms) {
+      string tag = h.first;
+      replace(tag.begin(), tag.end(), ' ', '_');
+      replace(tag.begin(), tag.end(), ',', '_');
+      o << "Tag=" << tag << "," << setprecision(3) << 0.0 << "," << interval << ","
+        << setprecision(9) << h.second->max_value() / 1e9 << "," << h.second->encode() << "\n";
+   }
+}
+
+// Outputs the percentiles of the solve times in a histogram, in microseconds.
+void report_percentiles(const string& label, const HdrHistogram& h) {
+   cerr << label << ": " << h.total() << " solves, p50 " << fixed << setprecision(1) << h.percentile(50) / 1e3
+        << " us, p99 " << h.percentile(99) / 1e3 << " us, p99.9 " << h.percentile(99.9) / 1e3
+        << " us, max " << h.max_value() / 1e3 << " us" << endl;
+   cerr << setprecision(6);
+}
+
+// =================================== Result Stream Output =======================================
+
+// Result files hold one line per puzzle: line number in the data file, solve time, search nodes and solution.
+// Written as plain text, or, if the file name ends in ".sdz", as a stream of independently compressed frames:
+//   header   "SDZ1".
+//   frames   compressed size, raw size, CRC-32 of the raw bytes and number of lines (uint32 each), followed by
+//            the lines compressed as one zlib stream. Each frame holds only whole lines.
+//   index    per frame: file offset (uint64), compressed size, raw size and number of lines (uint32 each).
+//   footer   file offset of the index (uint64), number of frames (uint32), "SDZI".
+// All integers are little-endian. The index lets a reader decode any frame on its own without reading the rest of
+// the file. Each worker fills its own buffer and compresses it once it reaches the frame size, so compression runs
+// in parallel and the lock is held only while the compressed frame is appended to the file.
+class ResultWriter {
+   struct Frame {
+      uint64_t offset;
+      uint32_t compressed_size, raw_size, lines;
+   };
+
+   ofstream _out;
+   bool _compress;
+   mutex _lock;
+   vector<Frame> _index;
+   uint64_t _offset = 0, _raw_bytes = 0;
+   double _seconds = 0;   // Time spent compressing and writing, summed over the workers.
+
+   static void put(string& out, uint64_t v, int bytes) {
+      for (int i = 0; i < bytes; i++) out += (char)(v >> (8*i));
+   }
+
+public:
+   static const size_t FRAME_SIZE = 256 * 1024;
+
+   ResultWriter(const string& path, bool compress) : _out(path, ios::binary), _compress(compress) {
+      if (_compress) {
+         _out.write("SDZ1", 4);
+         _offset = 4;
+      }
+   }
+
+   bool ok() const { return (bool)_out; }
+   uint64_t raw_bytes() const { return _raw_bytes; }
+   uint64_t written_bytes() const { return _offset; }
+   double seconds() const { return _seconds; }
+
+   // Writes a buffer of whole lines as one frame and clears it.
+   void write_frame(string& raw, uint32_t lines) {
+      if (raw.empty()) return;
+      auto start = chrono::steady_clock::now();
+      const uint32_t raw_size = raw.size();
+      string frame;
+      if (_compress) {
+         uLongf size = compressBound(raw_size);
+         string compressed(size, '\0');
+         compress2((Bytef*)&compressed[0], &size, (const Bytef*)raw.data(), raw_size, Z_BEST_SPEED);
+         put(frame, size, 4);
+         put(frame, raw_size, 4);
+         put(frame, crc32(0, (const Bytef*)raw.data(), raw_size), 4);
+         put(frame, lines, 4);
+         frame.append(compressed, 0, size);
+      } else {
+         frame.swap(raw);
+      }
+      raw.clear();
+
+      lock_guard<mutex> guard(_lock);
+      if (_compress) _index.push_back({_offset, (uint32_t)(frame.size() - 16), raw_size, lines});
+      _out.write(frame.data(), frame.size());
+      _offset += frame.size();
+      _raw_bytes += raw_size;
+      _seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+   }
+
+   // Writes the index and footer of a compressed stream. Called once every worker has written its last frame.
+   void close() {
+      if (_compress) {
+         string tail;
+         for (const Frame& f : _index) {
+            put(tail, f.offset, 8);
+            put(tail, f.compressed_size, 4);
+            put(tail, f.raw_size, 4);
+            put(tail, f.lines, 4);
+         }
+         put(tail, _offset, 8);
+         put(tail, _index.size(), 4);
+         tail += "SDZI";
+         _out.write(tail.data(), tail.size());
+         _offset += tail.size();
+      }
+      _out.close();
+   }
+};
+
+uint64_t get_le(const char* p, int bytes) {
+   uint64_t v = 0;
+   for (int i = 0; i < bytes; i++) v |= (uint64_t)(uint8_t)p[i] << (8*i);
+   return v;
+}
+
+// Outputs the lines of a compressed result stream, or of only one of its frames (counting from 0), using the index
+// to find them. The frames and their sizes are reported on the error stream.
+int read_results(const string& path, long only) {
+   ifstream in(path, ios::binary);
+   char buffer[20];
+   if (!in.read(buffer, 4) || memcmp(buffer, "SDZ1", 4) != 0) {
+      cerr << path << " is not a compressed result stream" << endl;
+      return 1;
+   }
+   in.seekg(-16, ios::end);
+   if (!in.read(buffer, 16) || memcmp(buffer + 12, "SDZI", 4) != 0) {
+      cerr << path << " has no frame index (the run may not have finished)" << endl;
+      return 1;
+   }
+   const uint64_t index_offset = get_le(buffer, 8);
+   const uint32_t frames = get_le(buffer + 8, 4);
+
+   uint64_t compressed_total = 0, raw_total = 0, lines_total = 0;
+   for (uint32_t f = 0; f < frames; f++) {
+      in.seekg(index_offset + 20 * f);
+      in.read(buffer, 20);
+      const uint64_t offset = get_le(buffer, 8);
+      const uint32_t compressed_size = get_le(buffer + 8, 4), raw_size = get_le(buffer + 12, 4);
+      const uint32_t lines = get_le(buffer + 16, 4);
+      compressed_total += compressed_size, raw_total += raw_size, lines_total += lines;
+      if (only >= 0 && f != only) continue;
+
+      string compressed(compressed_size, '\0'), raw(raw_size, '\0');
+      in.seekg(offset);
+      in.read(buffer, 16);
+      in.read(&compressed[0], compressed_size);
+      uLongf size = raw_size;
+      if (!in || uncompress((Bytef*)&raw[0], &size, (const Bytef*)compressed.data(), compressed_size) != Z_OK
+          || size != raw_size || crc32(0, (const Bytef*)raw.data(), raw_size) != get_le(buffer + 8, 4)) {
+         cerr << "Frame " << f << " of " << path << " is corrupt" << endl;
+         return 1;
+      }
+      cout << raw;
+   }
+   cerr << "Frames: " << frames << ", lines: " << lines_total << ", compressed bytes: " << compressed_total
+        << ", raw bytes: " << raw_total << ", ratio: " << (double)raw_total / max<uint64_t>(1, compressed_total)
+        << endl;
+   return 0;
+}
+
+// ======================================= Batch Running ==========================================
+
+// Reads one puzzle per line. Anything after the first comma, such as the technique columns of the "Correct" files
+// of Data Set 3, is kept in columns if it is given.
+vector<string> read_puzzles(const string& file, vector<string>* columns = nullptr) {
+   ifstream in(file);
+   vector<string> puzzles;
+   string line;
+   while (getline(in, line)) {
+      if (line.empty()) continue;
+      const size_t comma = line.find(',');
+      puzzles.push_back(line.substr(0, comma));
+      if (columns) columns->push_back(comma == string::npos ? "" : line.substr(comma + 1));
+   }
+   return puzzles;
+}
+
+// ==================================== Cooperative Search ========================================
+
+// The solver's search written with an explicit stack instead of recursion, so that the untried branches of a solve
+// can be handed to other workers while it runs. It visits the same nodes in the same order as solve().
+//
+// Each frame of the stack is a node of the search tree: the puzzle after the assignments leading to it, the cell
+// branched on, and the next digit to try there. Idle workers can join a search that is taking a long time; while
+// any of them is waiting, the worker holding the stack gives away every untried digit of its shallowest frame (the
+// largest untried subtrees) as new nodes in a shared pool, from which the waiting workers each take one and search
+// it with their own stack in the same way. The search ends when one worker finds a solution, or when the pool is
+// empty and no worker is searching.
+struct SearchFrame {
+   unique_ptr<Sudoku> state;
+   int cell;
+   int next;
+};
+
+struct SharedSearch {
+   mutex lock;
+   condition_variable changed;
+   vector< unique_ptr<Sudoku> > pool;   // Untried subtrees given away by the workers.
+   atomic<size_t> pool_size;
+   atomic<int> waiting;                 // Workers waiting for a subtree.
+   int busy = 1;                        // Workers searching a subtree (the owner to begin with).
+   int helpers = 0;                     // Workers that have joined the search.
+   atomic<bool> done;
+   unique_ptr<Sudoku> solution;
+   atomic<long> nodes;
+   const chrono::steady_clock::time_point start;
+
+   SharedSearch() : pool_size(0), waiting(0), done(false), nodes(0), start(chrono::steady_clock::now()) {}
+
+   void finish(unique_ptr<Sudoku> S) {
+      lock_guard<mutex> guard(lock);
+      if (!done) {
+         solution = std::move(S);
+         done = true;
+      }
+      changed.notify_all();
+   }
+};
+
+// Counts a new node of the search and either finishes the search, if the node is solved, or pushes it on the stack.
+void enter_node(SharedSearch& s, vector<SearchFrame>& stack, unique_ptr<Sudoku> S) {
+   s.nodes.fetch_add(1, memory_order_relaxed);
+   if (S->is_solved()) {
+      s.finish(std::move(S));
+      return;
+   }
+   const int k = S->least_count();
+   stack.push_back({std::move(S), k, 1});
+}
+
+// Gives every untried digit of the shallowest frame that has any to the pool, as new nodes.
+void give_away(SharedSearch& s, vector<SearchFrame>& stack) {
+   for (SearchFrame& f : stack) {
+      vector< unique_ptr<Sudoku> > subtrees;
+      for (; f.next <= 9; f.next++) {
+         if (!f.state->possible(f.cell).is_on(f.next)) continue;
+         unique_ptr<Sudoku> S1(new Sudoku(*f.state));
+         if (S1->assign(f.cell, f.next)) subtrees.push_back(std::move(S1));
+      }
+      if (subtrees.empty()) continue;
+
+      lock_guard<mutex> guard(s.lock);
+      for (auto& S : subtrees) s.pool.push_back(std::move(S));
+      s.pool_size = s.pool.size();
+      s.changed.notify_all();
+      return;
+   }
+}
+
+// Searches from the frames on the stack, then from nodes taken from the pool, until the search is over.
+// The caller must be counted in s.busy.
+void cooperate(SharedSearch& s, vector<SearchFrame>& stack) {
+   for (;;) {
+      while (!stack.empty() && !s.done.load(memory_order_relaxed)) {
+         if (s.waiting.load(memory_order_relaxed) > 0 && s.pool_size.load(memory_order_relaxed) == 0) {
+            give_away(s, stack);
+         }
+         SearchFrame& f = stack.back();
+         while (f.next <= 9 && !f.state->possible(f.cell).is_on(f.next)) f.next++;
+         if (f.next > 9) {
+            stack.pop_back();
+            continue;
+         }
+         unique_ptr<Sudoku> S1(new Sudoku(*f.state));
+         const bool consistent = S1->assign(f.cell, f.next++);
+         if (consistent) enter_node(s, stack, std::move(S1));
+      }
+      stack.clear();
+
+      unique_ptr<Sudoku> S;
+      {
+         unique_lock<mutex> l(s.lock);
+         s.busy--;
+         for (;;) {
+            if (s.done || (s.pool.empty() && s.busy == 0)) {
+               s.done = true;
+               s.changed.notify_all();
+               return;
+            }
+            if (!s.pool.empty()) break;
+            s.waiting++;
+            s.changed.wait(l);
+            s.waiting--;
+         }
+         S = std::move(s.pool.back());
+         s.pool.pop_back();
+         s.pool_size = s.pool.size();
+         s.busy++;
+      }
+      enter_node(s, stack, std::move(S));
+   }
+}
+
+// Solves a puzzle with the cooperative search, as the owner of the shared search state.
+unique_ptr<Sudoku> solve_shared(const string& puzzle, SharedSearch& s) {
+   vector<SearchFrame> stack;
+   enter_node(s, stack, unique_ptr<Sudoku>(new Sudoku(puzzle)));
+   cooperate(s, stack);
+   return std::move(s.solution);
+}
+
+// Joins a search as a helper. Returns false if it had already finished.
+bool join_search(SharedSearch& s) {
+   {
+      lock_guard<mutex> guard(s.lock);
+      if (s.done) return false;
+      s.busy++;
+      s.helpers++;
+   }
+   vector<SearchFrame> stack;
+   cooperate(s, stack);
+   return true;
+}
+
+// =================================== Batch Scheduling ===========================================
+
+// How the dispatch order is divided between the workers.
+// STATIC:   each worker is given one contiguous block of the order, of equal size, up front.
+// DYNAMIC:  workers take one puzzle at a time from a shared position in the order.
+// ADAPTIVE: workers take chunks sized so that each holds about TARGET_CHUNK seconds of work, going by the mean time
+//           of the puzzles solved so far in this batch, but never more than 1/(2 * threads) of the puzzles that
+//           are left, so that chunks shrink towards the end of the batch and the workers finish together.
+enum Schedule { STATIC, DYNAMIC, ADAPTIVE };
+
+const char* schedule_names[] = {"static", "dynamic", "adaptive"};
+
+// Hands out chunks of the dispatch order to the workers. Chunks are claimed from a shared atomic position by
+// compare-and-swap, so no locking is needed.
+class Scheduler {
+   const Schedule _schedule;
+   const size_t _size;
+   const int _threads;
+   atomic<size_t> _next;
+   atomic<uint64_t> _solved_ns, _solved;
+
+public:
+   static constexpr double TARGET_CHUNK = 1e-3;
+
+   Scheduler(Schedule schedule, size_t size, int threads)
+     : _schedule(schedule), _size(size), _threads(threads), _next(0), _solved_ns(0), _solved(0) {}
+
+   // Claims the next chunk of the order for worker w as [first, last), after adding the time taken by the
+   // puzzles of its previous chunk. Returns false once the whole order has been handed out.
+   bool claim(int w, size_t& first, size_t& last, uint64_t previous_ns, size_t previous_count);
+};
+
+bool Scheduler::claim(int w, size_t& first, size_t& last, uint64_t previous_ns, size_t previous_count) {
+   if (_schedule == STATIC) {
+      if (previous_count > 0 || first == _size) return false;
+      first = _size * w / _threads;
+      last = _size * (w + 1) / _threads;
+      return first < last;
+   }
+
+   size_t chunk = 1;
+   double mean = 0;
+   if (_schedule == ADAPTIVE) {
+      if (previous_count > 0) {
+         _solved_ns += previous_ns;
+         _solved += previous_count;
+      }
+      const uint64_t solved = _solved.load();
+      if (solved > 0) mean = _solved_ns.load() / 1e9 / solved;
+   }
+
+   size_t start = _next.load();
+   do {
+      if (start >= _size) return false;
+      if (mean > 0) {
+         const size_t by_time = TARGET_CHUNK / mean;
+         chunk = max<size_t>(1, min(by_time, (_size - start) / (2 * _threads)));
+      }
+   } while (!_next.compare_exchange_weak(start, min(_size, start + chunk)));
+   first = start;
+   last = min(_size, start + chunk);
+   return true;
+}
+
+// Outcome of solving a batch of puzzles.
+struct BatchResult {
+   vector<double> times;          // Solve time of each puzzle, in the order of the file.
+   HdrHistogram histogram = HdrHistogram::nanoseconds();
+   double seconds = 0;            // Wall time from starting the workers until the last one finished.
+   long claims = 0;               // Number of chunks handed out.
+   double scheduler_seconds = 0;  // Time spent claiming chunks, summed over the workers.
+   double finish_spread = 0;      // Time between the first and the last worker running out of work.
+   long promoted = 0;             // Number of solves joined by idle workers.
+};
+
+// Solves the puzzles in the dispatch order on the given number of threads, streaming results to the writer if
+// there is one. Each worker has its own histogram and counters, which are merged once they have all finished.
+//
+// With promotion, every puzzle is solved with the cooperative search, and a worker that finds no more puzzles to
+// claim joins the longest-running solve that has taken more than 10 times the mean solve time of the batch so far
+// (and at least 1 ms), instead of going idle while a straggler holds up the end of the batch.
+BatchResult solve_batch(const vector<string>& puzzles, const vector<size_t>& order, int threads, Schedule schedule,
+                        bool promote, ResultWriter* writer) {
+   BatchResult result;
+   result.times.resize(puzzles.size());
+   Scheduler scheduler(schedule, order.size(), threads);
+
+   vector<HdrHistogram> histograms(threads, HdrHistogram::nanoseconds());
+   vector<long> claims(threads, 0);
+   vector<double> claim_seconds(threads, 0), finished(threads, 0);
+   auto batch_start = chrono::steady_clock::now();
+
+   // Solves in progress, which idle workers may join, and the total time of the solves finished so far.
+   vector< shared_ptr<SharedSearch> > running(threads);
+   mutex running_lock;
+   vector<long> promoted(threads, 0);
+   atomic<uint64_t> solved_ns(0), solved(0);
+
+   auto worker = [&](int w) {
+      string buffer;
+      uint32_t lines = 0;
+      size_t first = 0, last = 0;
+      uint64_t chunk_ns = 0;
+      for (;;) {
+         auto claim_start = chrono::steady_clock::now();
+         const bool claimed = scheduler.claim(w, first, last, chunk_ns, last - first);
+         claim_seconds[w] += chrono::duration<double>(chrono::steady_clock::now() - claim_start).count();
+         if (!claimed) break;
+         claims[w]++;
+         chunk_ns = 0;
+
+         for (size_t i = first; i < last; i++) {
+            const size_t id = order[i];
+            long nodes = 0;
+            auto start = chrono::steady_clock::now();
+            unique_ptr<Sudoku> S;
+            if (promote) {
+               auto search = make_shared<SharedSearch>();
+               {
+                  lock_guard<mutex> guard(running_lock);
+                  running[w] = search;
+               }
+               S = solve_shared(puzzles[id], *search);
+               {
+                  lock_guard<mutex> guard(running_lock);
+                  running[w].reset();
+               }
+               lock_guard<mutex> guard(search->lock);
+               nodes = search->nodes;
+               promoted[w] += search->helpers > 0;
+            } else {
+               S = solve(unique_ptr<Sudoku>(new Sudoku(puzzles[id])), nodes);
+            }
+            const auto elapsed = chrono::steady_clock::now() - start;
+            const int64_t ns = chrono::duration_cast<chrono::nanoseconds>(elapsed).count();
+            if (promote) {
+               solved_ns += ns;
+               solved++;
+            }
+            result.times[id] = chrono::duration<double>(elapsed).count();
+            histograms[w].record(ns);
+            chunk_ns += ns;
+
+            if (writer) {
+               char fields[64];
+               snprintf(fields, sizeof(fields), "%zu,%.9f,%ld,", id + 1, result.times[id], nodes);
+               buffer += fields;
+               for (int k = 0; k < 81; k++) buffer += S ? (char)('0' + S->possible(k).val()) : '.';
+               buffer += '\n';
+               lines++;
+               if (buffer.size() >= ResultWriter::FRAME_SIZE) {
+                  writer->write_frame(buffer, lines);
+                  lines = 0;
+               }
+            }
+         }
+      }
+      if (writer) writer->write_frame(buffer, lines);
+
+      // Helps with stragglers until no solve is left running.
+      while (promote) {
+         const uint64_t count = solved.load();
+         const double threshold = max(1e-3, count > 0 ? 10 * (solved_ns.load() / 1e9) / count : 0.0);
+         const auto now = chrono::steady_clock::now();
+         shared_ptr<SharedSearch> target;
+         bool any_running = false;
+         {
+            lock_guard<mutex> guard(running_lock);
+            for (const auto& r : running) {
+               if (!r) continue;
+               any_running = true;
+               if (chrono::duration<double>(now - r->start).count() > threshold && (!target || r->start < target->start)) {
+                  target = r;
+               }
+            }
+         }
+         if (!any_running) break;
+         if (!target || !join_search(*target)) this_thread::sleep_for(chrono::microseconds(100));
+      }
+      finished[w] = chrono::duration<double>(chrono::steady_clock::now() - batch_start).count();
+   };
+
+   vector<thread> pool;
+   for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+   for (thread& t : pool) t.join();
+   result.seconds = chrono::duration<double>(chrono::steady_clock::now() - batch_start).count();
+
+   for (int t = 0; t < threads; t++) {
+      result.histogram.merge(histograms[t]);
+      result.claims += claims[t];
+      result.scheduler_seconds += claim_seconds[t];
+      result.promoted += promoted[t];
+   }
+   result.finish_spread = *max_element(finished.begin(), finished.end()) - *min_element(finished.begin(), finished.end());
+   return result;
+}
+
+// ==================================== Difficulty Predictors =====================================
+
+// Scores used to dispatch the puzzles predicted to take longest first; a higher score predicts a longer solve.
+// GIVENS:     fewer givens.
+// CANDIDATES: more candidates left in the unsolved cells after the solver's own propagation of the givens (naked
+//             and hidden singles), counted as the log of their product, i.e. the size of the space left to search.
+// TECHNIQUES: the columns that follow each puzzle in the "Correct" files of Data Set 3: more guesses and
+//             backtracks, then more uses of pairs and intersections.
+// PROBES:     the time predicted by the search tree size estimator (4 probes).
+// The first three cost a few microseconds per puzzle; the probes cost about as much as a solve of an easy puzzle.
+enum Predictor { FILE_ORDER, GIVENS, CANDIDATES, TECHNIQUES, PROBES };
+
+const char* predictor_names[] = {"file-order", "givens", "candidates", "techniques", "probes"};
+
+// Returns the log2 of the product of the numbers of candidates left in the cells of a puzzle after naked and hidden
+// singles. This is the propagation the solver's assign() does, but on bitmasks, so that it costs a small fraction of
+// constructing a Sudoku. A contradiction stops the propagation early.
+double log_candidates(const string& puzzle) {
+   static int unit_cell[27][9];
+   static once_flag units_built;
+   call_once(units_built, []() {
+      for (int i = 0; i < 9; i++) {
+         for (int j = 0; j < 9; j++) {
+            unit_cell[i][j] = i*9 + j;
+            unit_cell[9 + i][j] = j*9 + i;
+            unit_cell[18 + i][j] = (i/3)*27 + (i%3)*3 + (j/3)*9 + j%3;
+         }
+      }
+   });
+
+   uint16_t cand[81];
+   bool placed[81] = {false};
+   for (int k = 0; k < 81; k++) {
+      const char c = k < (int)puzzle.size() ? puzzle[k] : '.';
+      cand[k] = c >= '1' && c <= '9' ? 1 << (c - '1') : 0x1FF;
+   }
+
+   // Runs until no cell is newly placed, or a cell is left with no candidates.
+   bool changed = true, contradiction = false;
+   while (changed && !contradiction) {
+      changed = false;
+      // Naked singles: a cell with one candidate removes it from its peers.
+      for (int k = 0; k < 81 && !contradiction; k++) {
+         if (placed[k] || __builtin_popcount(cand[k]) != 1) continue;
+         placed[k] = changed = true;
+         for (int u : {k / 9, 9 + k % 9, 18 + (k / 27)*3 + (k % 9)/3}) {
+            for (int j : unit_cell[u]) {
+               if (j != k) cand[j] &= ~cand[k];
+               contradiction |= cand[j] == 0;
+            }
+         }
+      }
+      // Hidden singles: a digit that only one cell of a unit can hold is placed there, on the next pass.
+      for (int u = 0; u < 27 && !contradiction; u++) {
+         uint16_t once = 0, twice = 0;
+         for (int j : unit_cell[u]) twice |= once & cand[j], once |= cand[j];
+         const uint16_t hidden = once & ~twice;
+         for (int j : unit_cell[u]) {
+            const uint16_t single = cand[j] & hidden;
+            if (single && cand[j] != single) {
+               cand[j] = single;
+               changed = true;
+               contradiction |= __builtin_popcount(single) > 1;
+            }
+         }
+      }
+   }
+
+   double log_product = 0;
+   for (int k = 0; k < 81; k++) log_product += log2(max(1, __builtin_popcount(cand[k])));
+   return log_product;
+}
+
+// Returns the score of each puzzle, computed on the given number of threads, or an empty vector if the predictor needs
+// technique columns that a puzzle lacks.
+vector<double> predict(const vector<string>& puzzles, const vector<string>& columns, Predictor predictor, int threads) {
+   vector<double> score(puzzles.size(), 0);
+   atomic<bool> missing_columns(false);
+
+   auto worker = [&](int w) {
+      for (size_t i = w; i < puzzles.size(); i += threads) {
+         const string& p = puzzles[i];
+         if (predictor == GIVENS) {
+            score[i] = -count_if(p.begin(), p.end(), [](char c) { return c >= '1' && c <= '9'; });
+         } else if (predictor == CANDIDATES) {
+            score[i] = log_candidates(p);
+         } else if (predictor == TECHNIQUES) {
+            // givens, singles, hidden singles, naked pairs, hidden pairs, pointing pairs/triples,
+            // box/line intersections, guesses, backtracks.
+            int c[9];
+            if (i >= columns.size() || sscanf(columns[i].c_str(), "%d,%d,%d,%d,%d,%d,%d,%d,%d", &c[0], &c[1], &c[2],
+                                              &c[3], &c[4], &c[5], &c[6], &c[7], &c[8]) != 9) {
+               missing_columns = true;
+               return;
+            }
+            score[i] = 1000.0 * (c[7] + c[8]) + c[3] + c[4] + c[5] + c[6];
+         } else if (predictor == PROBES) {
+            score[i] = estimate_tree(p, 4, i).seconds;
+         }
+      }
+   };
+
+   if (predictor == FILE_ORDER) return score;
+   vector<thread> pool;
+   for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+   for (thread& t : pool) t.join();
+   return missing_columns ? vector<double>() : score;
+}
+
+// Returns the order in which the puzzles are dispatched: file order, or decreasing score. Ties keep file order.
+vector<size_t> dispatch_order(const vector<double>& score) {
+   vector<size_t> order(score.size());
+   iota(order.begin(), order.end(), 0);
+   stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return score[a] > score[b]; });
+   return order;
+}
+
+// Solves every puzzle in the file on the given number of threads, with the puzzles divided between the threads
+// by the given schedule. Results are stored by position in the file and output in that order once every worker
+// has finished. If an output file is given, the line number, time, nodes and solution of each puzzle are also
+// streamed to it as they finish (in order of completion).
+int run_batch(const string& file, int threads, Predictor predictor, Schedule schedule, bool promote,
+              const string& output) {
+   vector<string> columns;
+   const vector<string> puzzles = read_puzzles(file, &columns);
+   if (puzzles.empty()) {
+      cerr << "Could not read any puzzles from " << file << endl;
+      return 1;
+   }
+
+   auto batch_start = chrono::steady_clock::now();
+   const vector<double> score = predict(puzzles, columns, predictor, threads);
+   if (score.empty()) {
+      cerr << file << " does not have technique columns for every puzzle" << endl;
+      return 1;
+   }
+   const vector<size_t> order = dispatch_order(score);
+   const double ordering_time = chrono::duration<double>(chrono::steady_clock::now() - batch_start).count();
+
+   const bool compress = output.size() > 4 && output.compare(output.size() - 4, 4, ".sdz") == 0;
+   unique_ptr<ResultWriter> writer(output.empty() ? nullptr : new ResultWriter(output, compress));
+   if (writer && !writer->ok()) {
+      cerr << "Could not open " << output << endl;
+      return 1;
+   }
+
+   const BatchResult result = solve_batch(puzzles, order, threads, schedule, promote, writer.get());
+   if (writer) writer->close();
+
+   const double makespan = chrono::duration<double>(chrono::steady_clock::now() - batch_start).count();
+
+   // Outputs the time taken to solve each sudoku puzzle, in the order of the file.
+   for (double t : result.times) cout << fixed << t << endl;
+
+   cerr << "Puzzles: " << puzzles.size() << ", threads: " << threads
+        << ", dispatch: " << (predictor == FILE_ORDER ? "file order" : "longest predicted first by ")
+        << (predictor == FILE_ORDER ? "" : predictor_names[predictor])
+        << ", schedule: " << schedule_names[schedule] << (promote ? " with straggler promotion" : "") << endl;
+   cerr << "Ordering time: " << ordering_time << " s, makespan (including ordering): " << makespan << " s" << endl;
+   cerr << "Chunks: " << result.claims << ", scheduler time: " << result.scheduler_seconds
+        << " s, spread of worker finish times: " << result.finish_spread << " s" << endl;
+   if (promote) cerr << "Solves joined by idle workers: " << result.promoted << endl;
+   report_percentiles(file, result.histogram);
+   if (writer) {
+      cerr << "Results: " << writer->raw_bytes() << " bytes, written as " << writer->written_bytes() << " bytes to "
+           << output << " (ratio " << (double)writer->raw_bytes() / writer->written_bytes() << "), "
+           << writer->seconds() << " s spent writing across the workers" << endl;
+   }
+
+   const double now = chrono::duration<double>(chrono::system_clock::now().time_since_epoch()).count();
+   write_histogram_log("Batch Solve Times.hlog", now - makespan, makespan, {{file, &result.histogram}});
+   return 0;
+}
+
+// Solves the file once with each schedule, without and with straggler promotion, in file order, and reports the
+// makespan and scheduling cost of each.
+int compare_schedules(const string& file, int threads) {
+   const vector<string> puzzles = read_puzzles(file);
+   if (puzzles.empty()) {
+      cerr << "Could not read any puzzles from " << file << endl;
+      return 1;
+   }
+   const vector<size_t> order = dispatch_order(vector<double>(puzzles.size(), 0));
+
+   cout << "schedule,promotion,threads,makespan,chunks,scheduler time,finish spread,promoted solves" << endl;
+   for (Schedule s : {STATIC, DYNAMIC, ADAPTIVE}) {
+      for (bool promote : {false, true}) {
+         const BatchResult r = solve_batch(puzzles, order, threads, s, promote, nullptr);
+         cout << schedule_names[s] << "," << (promote ? "on" : "off") << "," << threads << "," << fixed << r.seconds
+              << "," << r.claims << "," << r.scheduler_seconds << "," << r.finish_spread << "," << r.promoted << endl;
+      }
+   }
+   return 0;
+}
+
+// Returns the makespan of solving the puzzles in the given order on the given number of workers, taking one puzzle at
+// a time as the dynamic schedule does, if each takes the given time.
+double simulate_makespan(const vector<size_t>& order, const vector<double>& times, int threads) {
+   vector<double> free_at(threads, 0);
+   for (size_t id : order) {
+      auto w = min_element(free_at.begin(), free_at.end());
+      *w += times[id];
+   }
+   return *max_element(free_at.begin(), free_at.end());
+}
+
+// Returns the rank of each value, from 1, with tied values given the mean of their ranks.
+vector<double> ranks(const vector<double>& v) {
+   vector<size_t> order(v.size());
+   iota(order.begin(), order.end(), 0);
+   sort(order.begin(), order.end(), [&](size_t a, size_t b) { return v[a] < v[b]; });
+   vector<double> rank(v.size());
+   for (size_t i = 0; i < order.size();) {
+      size_t j = i;
+      while (j < order.size() && v[order[j]] == v[order[i]]) j++;
+      for (size_t k = i; k < j; k++) rank[order[k]] = (i + j + 1) / 2.0;
+      i = j;
+   }
+   return rank;
+}
+
+// Spearman rank correlation of two equally long vectors.
+double rank_correlation(const vector<double>& a, const vector<double>& b) {
+   const vector<double> ra = ranks(a), rb = ranks(b);
+   const double mean = (ra.size() + 1) / 2.0;
+   double cov = 0, va = 0, vb = 0;
+   for (size_t i = 0; i < ra.size(); i++) {
+      cov += (ra[i] - mean) * (rb[i] - mean);
+      va += (ra[i] - mean) * (ra[i] - mean);
+      vb += (rb[i] - mean) * (rb[i] - mean);
+   }
+   return (va > 0 && vb > 0) ? cov / sqrt(va * vb) : 0;
+}
+
+// Compares the predictors on a file, ideally one mixing difficulties. Every puzzle is first solved once on one thread
+// to find its actual time. Then, for each predictor, reports its cost, the rank correlation of its scores with the
+// actual times, the makespan of dispatching longest-predicted-first on the given number of threads (simulated from the
+// actual times, so that it does not depend on the number of cores, and measured with the dynamic schedule, including
+// the time taken to predict), and the improvement of each makespan over file order. The lower bound on the makespan,
+// the larger of the mean work per thread and the longest solve, is reported for reference.
+int compare_predictors(const string& file, int threads) {
+   vector<string> columns;
+   const vector<string> puzzles = read_puzzles(file, &columns);
+   if (puzzles.empty()) {
+      cerr << "Could not read any puzzles from " << file << endl;
+      return 1;
+   }
+
+   vector<double> actual(puzzles.size());
+   for (size_t i = 0; i < puzzles.size(); i++) {
+      long nodes = 0;
+      auto start = chrono::steady_clock::now();
+      solve(unique_ptr<Sudoku>(new Sudoku(puzzles[i])), nodes);
+      actual[i] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+   }
+   const double total = accumulate(actual.begin(), actual.end(), 0.0);
+   cerr << "Puzzles: " << puzzles.size() << ", total solve time: " << total << " s, lower bound on the makespan: "
+        << max(total / threads, *max_element(actual.begin(), actual.end())) << " s" << endl;
+
+   cout << "predictor,threads,prediction time,rank correlation,simulated makespan,simulated improvement,"
+           "measured makespan,measured improvement" << endl;
+   double simulated_base = 0, measured_base = 0;
+   for (Predictor p : {FILE_ORDER, GIVENS, CANDIDATES, TECHNIQUES, PROBES}) {
+      auto start = chrono::steady_clock::now();
+      const vector<double> score = predict(puzzles, columns, p, threads);
+      const double prediction_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      if (score.empty()) {
+         cout << predictor_names[p] << "," << threads << ",no technique columns" << endl;
+         continue;
+      }
+      const vector<size_t> order = dispatch_order(score);
+      const double simulated = simulate_makespan(order, actual, threads);
+      const double measured = prediction_time + solve_batch(puzzles, order, threads, DYNAMIC, false, nullptr).seconds;
+      if (p == FILE_ORDER) simulated_base = simulated, measured_base = measured;
+
+      cout << predictor_names[p] << "," << threads << "," << fixed << prediction_time << ","
+           << (p == FILE_ORDER ? 0 : rank_correlation(score, actual)) << "," << simulated << ","
+           << simulated_base / simulated << "," << measured << "," << measured_base / measured << endl;
+   }
+   return 0;
+}
+
+// Merges the histograms with the same tag across HdrHistogram logs and reports their percentiles.
+int merge_logs(const vector<string>& paths) {
+   map<string, HdrHistogram> merged;
+   for (const string& path : paths) {
+      ifstream in(path);
+      if (!in) {
+         cerr << "Could not open " << path << endl;
+         return 1;
+      }
+      string line;
+      while (getline(in, line)) {
+         if (line.empty() || line[0] == '#' || line[0] == '"') continue;
+
+         // Tag=<tag>,<start>,<length>,<max>,<histogram>; the tag is optional.
+         string tag;
+         if (line.compare(0, 4, "Tag=") == 0) {
+            tag = line.substr(4, line.find(',') - 4);
+            line = line.substr(line.find(',') + 1);
+         }
+         const size_t last = line.rfind(',');
+         if (last == string::npos) continue;
+         auto it = merged.emplace(tag, HdrHistogram::nanoseconds()).first;
+         if (!it->second.merge_encoded(line.substr(last + 1))) {
+            cerr << "Could not decode a histogram in " << path << endl;
+            return 1;
+         }
+      }
+   }
+   for (const auto& m : merged) report_percentiles(m.first, m.second);
+   return 0;
+}
+
+// ==================================== Estimator Accuracy ========================================
+
+// For every puzzle in the four difficulty files, compares the estimated tree size and time against an actual
+// solve, and reports per file: mean predicted and actual nodes, the mean absolute error of log10(nodes), the
+// correlation between log predicted and log actual time, and the cost of estimating relative to solving.
+int report_accuracy(int probes) {
+   const vector<string> files = {"Easy Sudokus.txt", "Medium Sudokus.txt", "Hard Sudokus.txt", "Diabolical Sudokus.txt"};
+
+   cout << "file,puzzles,mean predicted nodes,mean actual nodes,mean |log10 error| nodes,"
+           "log time correlation,estimate time / solve time" << endl;
+
+   for (const string& file : files) {
+      const vector<string> puzzles = read_puzzles(file);
+      if (puzzles.empty()) {
+         cerr << "Could not read any puzzles from " << file << endl;
+         continue;
+      }
+
+      double predicted_nodes = 0, actual_nodes = 0, log_error = 0, estimate_time = 0, solve_time = 0;
+      vector<double> log_predicted, log_actual;
+
+      for (size_t i = 0; i < puzzles.size(); i++) {
+         auto start = chrono::steady_clock::now();
+         const Estimate e = estimate_tree(puzzles[i], probes, i);
+         auto middle = chrono::steady_clock::now();
+         long nodes = 0;
+         solve(unique_ptr<Sudoku>(new Sudoku(puzzles[i])), nodes);
+         auto end = chrono::steady_clock::now();
+
+         const double solve_seconds = chrono::duration<double>(end - middle).count();
+         estimate_time += chrono::duration<double>(middle - start).count();
+         solve_time += solve_seconds;
+         predicted_nodes += e.nodes;
+         actual_nodes += nodes;
+         log_error += fabs(log10(e.nodes) - log10((double)nodes));
+         log_predicted.push_back(log10(max(e.seconds, 1e-9)));
+         log_actual.push_back(log10(max(solve_seconds, 1e-9)));
+      }
+
+      // Pearson correlation of the log times.
+      const double n = puzzles.size();
+      const double mp = accumulate(log_predicted.begin(), log_predicted.end(), 0.0) / n;
+      const double ma = accumulate(log_actual.begin(), log_actual.end(), 0.0) / n;
+      double cov = 0, vp = 0, va = 0;
+      for (size_t i = 0; i < puzzles.size(); i++) {
+         cov += (log_predicted[i] - mp) * (log_actual[i] - ma);
+         vp += (log_predicted[i] - mp) * (log_predicted[i] - mp);
+         va += (log_actual[i] - ma) * (log_actual[i] - ma);
+      }
+      const double correlation = (vp > 0 && va > 0) ? cov / sqrt(vp * va) : 0;
+
+      cout << file << "," << puzzles.size() << "," << fixed << predicted_nodes / n << "," << actual_nodes / n << ","
+           << log_error / n << "," << correlation << "," << estimate_time / solve_time << endl;
+   }
+   return 0;
+}
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   Sudoku::init();
+
+   if (argc >= 2 && strcmp(argv[1], "estimate") == 0) {
+      const int probes = argc > 2 ? stoi(argv[2]) : 4;
+      if (probes < 1) {
+         cerr << "The number of probes must be at least 1" << endl;
+         return 1;
+      }
+      return report_accuracy(probes);
+   }
+   if (argc >= 3 && strcmp(argv[1], "run") == 0) {
+      const int threads = argc > 3 ? stoi(argv[3]) : max(1u, thread::hardware_concurrency());
+      // Options: a comma-separated list of a dispatch order, a schedule and promotion.
+      const string options = argc > 4 ? argv[4] : "";
+      Predictor predictor = FILE_ORDER;
+      bool promote = false;
+      Schedule schedule = DYNAMIC;
+      size_t pos = 0;
+      while (pos <= options.size()) {
+         const size_t end = min(options.find(',', pos), options.size());
+         const string option = options.substr(pos, end - pos);
+         if (option == "longest-first") predictor = PROBES;
+         else if (option == "givens") predictor = GIVENS;
+         else if (option == "candidates") predictor = CANDIDATES;
+         else if (option == "techniques") predictor = TECHNIQUES;
+         else if (option == "probes") predictor = PROBES;
+         else if (option == "static") schedule = STATIC;
+         else if (option == "adaptive") schedule = ADAPTIVE;
+         else if (option == "promote") promote = true;
+         else if (option != "file-order" && option != "dynamic" && !option.empty()) {
+            cerr << "Unknown option " << option << endl;
+            return 1;
+         }
+         pos = end + 1;
+      }
+      return run_batch(argv[2], threads, predictor, schedule, promote, argc > 5 ? argv[5] : "");
+   }
+   if (argc >= 3 && strcmp(argv[1], "schedules") == 0) {
+      return compare_schedules(argv[2], argc > 3 ? stoi(argv[3]) : max(1u, thread::hardware_concurrency()));
+   }
+   if (argc >= 3 && strcmp(argv[1], "predictors") == 0) {
+      return compare_predictors(argv[2], argc > 3 ? stoi(argv[3]) : max(1u, thread::hardware_concurrency()));
+   }
+   if (argc >= 3 && strcmp(argv[1], "read") == 0) {
+      return read_results(argv[2], argc > 3 ? stol(argv[3]) : -1);
+   }
+
+   if (argc >= 3 && strcmp(argv[1], "merge") == 0) {
+      return merge_logs(vector<string>(argv + 2, argv + argc));
+   }
+
+   cerr << "Usage: " << argv[0] << " estimate [probes] | run <file> [threads] [options] [output] | schedules <file> [threads]"
+        << " | predictors <file> [threads] | read <results> [frame]"
+        << " | merge <logs...>"
+        << endl;
+   return 1;
+}
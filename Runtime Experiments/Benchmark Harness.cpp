@@ -0,0 +1,1415 @@
+// Benchmark harness running the solvers from this folder over the Runtime Data files.
+// The backtracking algorithm is taken from "Backtracking Algorithm.cpp" (https://www.geeksforgeeks.org/sudoku-backtracking-7/)
+// and the Norvig solver from "Norvig Solver.cpp" (https://github.com/daochenw/sudoku). Both have been edited only to
+// report their assignments, eliminations, contradictions, branches and backtracks to an observer given as a template
+// parameter, which counts the work they do so that a slow solve can be explained as well as timed, or traces it, or
+// records the search tree. New instruments are written as observers without changing the engines. The observers
+// cover only the engines of this file; the other self-contained programs in this folder keep their own copies.
+// A third engine solves the puzzles as graph colouring, by exact DSATUR search over the sudoku constraint graph.
+//
+// Unlike the original drivers, every time is reported together with the engine, file and line number of the puzzle.
+// The K slowest solves of each engine are also kept and written to "Slowest Sudokus.txt" as replay bundles
+// (engine, file, puzzle number, seed, time, counters and the puzzle itself), one bundle per line.
+//
+// Where the CPU exposes RAPL energy counters through the Linux powercap interface (/sys/class/powercap, Intel and
+// recent AMD processors), the package and DRAM energy used by each engine on each file is also reported as joules per
+// puzzle. Without powercap (other platforms, virtual machines, or counters readable only by root) energy is reported
+// as unavailable and the benchmark runs as normal.
+//
+// Every individual solve time is recorded in an HDR histogram per engine and file, from which the median, 99th and
+// 99.9th percentiles and maximum are reported. The histograms are also written to "Solve Times.hlog" in the standard
+// HdrHistogram log format, tagged engine:file, so they can be merged with those of other runs or plotted.
+//
+// The search tree built by either engine for a single puzzle can also be recorded and exported in a compact binary
+// form, as a Graphviz DOT file and as JSON summarising subtree sizes and the depths at which branches fail.
+//
+// Compile with: g++ -O2 -o harness "Benchmark Harness.cpp" -lz
+//
+// Usage:
+//   ./harness [K]                  benchmarks all four difficulty files, keeping the K slowest solves (default 10).
+//   ./harness replay <bundles>     re-runs every bundle in the file once with tracing turned on.
+//   ./harness tree <engine> <file> <puzzle number> <output prefix> [max nodes]
+//                                  records the search tree of one puzzle and writes <prefix>.bin, .dot and .json.
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <zlib.h>
+#include <dirent.h>
+using namespace std;
+
+// ===================================== Solver Observers =========================================
+
+// Every engine reports what it does to an observer, a class passed as a template parameter, through five hooks:
+//   on_assign(cell, digit)             a cell is left with a single digit, by a branch, a given or propagation.
+//   on_eliminate(cell, digit)          a digit is removed from the candidates of a cell.
+//   on_contradiction(cell)             an assignment (of a branch or the givens) has failed, at this cell. Reported
+//                                      once per failed assignment, before the search would go below it; engines
+//                                      without propagation never report one.
+//   on_branch(parent, cell, digit)     the search tries the digit in the cell below node parent, or opens the root
+//                                      (parent -1, cell -1, digit 0). Returns an id for the new node, which is passed
+//                                      back as the parent of the branches below it and to on_backtrack.
+//   on_backtrack(node, cell, digit)    the branch into node has failed and is undone.
+// The hooks are called directly, not through virtual functions, so an instrument is added by writing an observer
+// rather than by editing the engines, and an observer whose hooks are empty compiles away entirely.
+
+// Observer that ignores every event.
+struct NullObserver {
+   void on_assign(int, int) {}
+   void on_eliminate(int, int) {}
+   void on_contradiction(int) {}
+   int  on_branch(int, int, int) { return -1; }
+   void on_backtrack(int, int, int) {}
+};
+
+// Counts the work done by an engine while solving one sudoku puzzle.
+// nodes: number of search nodes visited (calls to the recursive search), i.e. the branches, including the root,
+//        whose assignment did not fail.
+// backtracks: number of tentative assignments that had to be undone.
+// propagations: number of candidate eliminations (always 0 for the backtracking algorithm, which does not propagate).
+//               For DSATUR, the number of times a colour became unavailable to an uncoloured vertex.
+struct SolveStats {
+   long nodes = 0;
+   long backtracks = 0;
+   long propagations = 0;
+
+   void on_assign(int, int) {}
+   void on_eliminate(int, int) { propagations++; }
+   void on_contradiction(int) { nodes--; }
+   int  on_branch(int, int, int) { nodes++; return -1; }
+   void on_backtrack(int, int, int) { backtracks++; }
+};
+
+// Prints every branch, backtrack and contradiction to the terminal as it happens.
+struct TraceObserver {
+   void on_assign(int, int) {}
+   void on_eliminate(int, int) {}
+   void on_contradiction(int cell) {
+      cout << "fail   r" << cell/9 + 1 << "c" << cell%9 + 1 << endl;
+   }
+   int  on_branch(int, int cell, int digit) {
+      if (cell >= 0) cout << "assign r" << cell/9 + 1 << "c" << cell%9 + 1 << "=" << digit << endl;
+      return -1;
+   }
+   void on_backtrack(int, int cell, int digit) {
+      cout << "undo   r" << cell/9 + 1 << "c" << cell%9 + 1 << "=" << digit << endl;
+   }
+};
+
+// Passes every event to two observers in turn. Node ids are those returned by the second.
+template <class First, class Second>
+struct ObserverPair {
+   First& first;
+   Second& second;
+
+   void on_assign(int cell, int digit) { first.on_assign(cell, digit); second.on_assign(cell, digit); }
+   void on_eliminate(int cell, int digit) { first.on_eliminate(cell, digit); second.on_eliminate(cell, digit); }
+   void on_contradiction(int cell) { first.on_contradiction(cell); second.on_contradiction(cell); }
+   int  on_branch(int parent, int cell, int digit) {
+      first.on_branch(parent, cell, digit);
+      return second.on_branch(parent, cell, digit);
+   }
+   void on_backtrack(int node, int cell, int digit) {
+      first.on_backtrack(node, cell, digit);
+      second.on_backtrack(node, cell, digit);
+   }
+};
+
+// ================================= Search Tree Recording ========================================
+
+// Outcome of the subtree below a recorded node.
+enum NodeResult : uint8_t { NODE_OPEN = 0, NODE_SOLVED = 1, NODE_FAILED = 2 };
+
+// One node of a recorded search tree, packed into 12 bytes. Nodes are stored in the order they are
+// visited, so a parent always has a smaller index than its children.
+struct TreeNode {
+   int32_t  parent;        // Index of the parent node, -1 for the root.
+   uint8_t  cell;          // Cell (0-80) assigned on the branch into this node, 255 for the root.
+   uint8_t  digit;         // Digit assigned on the branch into this node, 0 for the root.
+   uint8_t  result;        // One of NodeResult.
+   uint8_t  depth;         // Number of branches between this node and the root.
+   uint32_t propagations;  // Eliminations made by the assignment into this node (0 for the backtracking algorithm).
+};
+
+// Observer recording every node of a search into a buffer reserved up front, so that recording never allocates.
+// Once the buffer is full, further nodes are dropped and the tree is marked as truncated.
+// Eliminations are counted against the node most recently opened: the engines only propagate between opening a
+// node and searching below it, so these are exactly the eliminations made by the assignment into that node.
+class TreeRecorder {
+   vector<TreeNode> _nodes;
+   size_t _capacity;
+   bool _truncated = false;
+   int _current = -1;
+public:
+   explicit TreeRecorder(size_t capacity) : _capacity(capacity) { _nodes.reserve(capacity); }
+
+   void on_assign(int, int) {}
+   void on_contradiction(int) {}
+
+   void on_eliminate(int, int) {
+      if (_current >= 0) _nodes[_current].propagations++;
+   }
+
+   // Adds a node below parent (-1 for the root) and returns its index, or -1 if it was dropped.
+   int on_branch(int parent, int cell, int digit) {
+      if (_nodes.size() == _capacity || (parent < 0 && !_nodes.empty())) {
+         _truncated = _truncated || _nodes.size() == _capacity;
+         return _current = -1;
+      }
+      const uint8_t depth = parent < 0 ? 0 : _nodes[parent].depth + 1;
+      _nodes.push_back({parent, (uint8_t)(cell < 0 ? 255 : cell), (uint8_t)digit, NODE_OPEN, depth, 0});
+      return _current = (int)_nodes.size() - 1;
+   }
+
+   void on_backtrack(int node, int, int) {
+      if (node >= 0) _nodes[node].result = NODE_FAILED;
+   }
+
+   // Sets the outcome of the nodes still open once the search has finished. Every node that did not fail
+   // lies on the path to the solution, or is the root of a search that found none.
+   void finish(bool solved) {
+      for (TreeNode& n : _nodes) {
+         if (n.result == NODE_OPEN) n.result = solved ? NODE_SOLVED : NODE_FAILED;
+      }
+   }
+
+   const vector<TreeNode>& nodes() const { return _nodes; }
+   bool truncated() const { return _truncated; }
+};
+
+// ================================= Backtracking Algorithm =======================================
+
+// UNASSIGNED is used for empty
+// cells in sudoku grid
+#define UNASSIGNED 0
+
+// N is used for the size of Sudoku grid.
+// Size will be NxN
+#define N 9
+
+bool FindUnassignedLocation(int grid[N][N], int& row, int& col);
+bool isSafe(int grid[N][N], int row, int col, int num);
+
+/* Takes a partially filled-in grid and attempts
+to assign values to all unassigned locations in
+such a way to meet the requirements for
+Sudoku solution (non-duplication across rows,
+columns, and boxes) */
+template <class Observer>
+bool SolveSudoku(int grid[N][N], Observer& obs, int node)
+{
+	int row, col;
+
+	// If there is no unassigned location,
+	// we are done
+	if (!FindUnassignedLocation(grid, row, col))
+		// success!
+		return true;
+
+	// Consider digits 1 to 9
+	for (int num = 1; num <= 9; num++)
+	{
+		// Check if looks promising
+		if (isSafe(grid, row, col, num))
+		{
+			const int child = obs.on_branch(node, row * N + col, num);
+
+			// Make tentative assignment
+			grid[row][col] = num;
+			obs.on_assign(row * N + col, num);
+
+			// Return, if success
+			if (SolveSudoku(grid, obs, child))
+				return true;
+
+			// Failure, unmake & try again
+			grid[row][col] = UNASSIGNED;
+			obs.on_backtrack(child, row * N + col, num);
+		}
+	}
+
+	// This triggers backtracking
+	return false;
+}
+
+/* Searches the grid to find an entry that is
+still unassigned. If found, the reference
+parameters row, col will be set the location
+that is unassigned, and true is returned.
+If no unassigned entries remain, false is returned. */
+bool FindUnassignedLocation(int grid[N][N], int& row, int& col)
+{
+	for (row = 0; row < N; row++)
+		for (col = 0; col < N; col++)
+			if (grid[row][col] == UNASSIGNED)
+				return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+an assigned entry in the specified row matches
+the given number. */
+bool UsedInRow(int grid[N][N], int row, int num)
+{
+	for (int col = 0; col < N; col++)
+		if (grid[row][col] == num)
+			return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+an assigned entry in the specified column
+matches the given number. */
+bool UsedInCol(int grid[N][N], int col, int num)
+{
+	for (int row = 0; row < N; row++)
+		if (grid[row][col] == num)
+			return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+an assigned entry within the specified 3x3 box
+matches the given number. */
+bool UsedInBox(int grid[N][N], int boxStartRow, int boxStartCol, int num)
+{
+	for (int row = 0; row < 3; row++)
+		for (int col = 0; col < 3; col++)
+			if (grid[row + boxStartRow][col + boxStartCol] == num)
+				return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+it will be legal to assign num to the given
+row, col location. */
+bool isSafe(int grid[N][N], int row, int col, int num)
+{
+	/* Check if 'num' is not already placed in
+	current row, current column
+	and current 3x3 box */
+	return !UsedInRow(grid, row, num)
+		&& !UsedInCol(grid, col, num)
+		&& !UsedInBox(grid, row - row % 3, col - col % 3, num)
+		&& grid[row][col] == UNASSIGNED;
+}
+
+#undef N
+
+// ===================================== Norvig Solver ============================================
+
+class Possible {
+   vector<bool> _b;
+public:
+   Possible() : _b(9, true) {}
+   bool   is_on(int i) const { return _b[i-1]; }
+   int    count()      const { return std::count(_b.begin(), _b.end(), true); }
+   void   eliminate(int i)   { _b[i-1] = false; }
+   int    val()        const {
+      auto it = find(_b.begin(), _b.end(), true);
+      return (it != _b.end() ? 1 + (it - _b.begin()) : -1);
+   }
+};
+
+class Sudoku {
+   vector<Possible> _cells;
+   static vector< vector<int> > _group, _neighbors, _groups_of;
+
+   template <class Observer>
+   bool     eliminate(int k, int val, Observer& obs);
+public:
+   template <class Observer>
+   Sudoku(string s, Observer& obs);
+   static void init();
+
+   Possible possible(int k) const { return _cells[k]; }
+   bool     is_solved() const;
+   template <class Observer>
+   bool     assign(int k, int val, Observer& obs);
+   int      least_count() const;
+};
+
+bool Sudoku::is_solved() const {
+   for (int k = 0; k < _cells.size(); k++) {
+      if (_cells[k].count() != 1) {
+         return false;
+      }
+   }
+   return true;
+}
+
+vector< vector<int> >
+Sudoku::_group(27), Sudoku::_neighbors(81), Sudoku::_groups_of(81);
+
+void Sudoku::init() {
+   for (int i = 0; i < 9; i++) {
+      for (int j = 0; j < 9; j++) {
+         const int k = i*9 + j;
+         const int x[3] = {i, 9 + j, 18 + (i/3)*3 + j/3};
+         for (int g = 0; g < 3; g++) {
+            _group[x[g]].push_back(k);
+            _groups_of[k].push_back(x[g]);
+         }
+      }
+   }
+   for (int k = 0; k < _neighbors.size(); k++) {
+      for (int x = 0; x < _groups_of[k].size(); x++) {
+         for (int j = 0; j < 9; j++) {
+            int k2 = _group[_groups_of[k][x]][j];
+            if (k2 != k) _neighbors[k].push_back(k2);
+         }
+      }
+   }
+}
+
+template <class Observer>
+bool Sudoku::assign(int k, int val, Observer& obs) {
+   for (int i = 1; i <= 9; i++) {
+      if (i != val) {
+         if (!eliminate(k, i, obs)) return false;
+      }
+   }
+   return true;
+}
+
+template <class Observer>
+bool Sudoku::eliminate(int k, int val, Observer& obs) {
+   if (!_cells[k].is_on(val)) {
+      return true;
+   }
+   _cells[k].eliminate(val);
+   obs.on_eliminate(k, val);
+   const int N = _cells[k].count();
+   if (N == 0) {
+      obs.on_contradiction(k);
+      return false;
+   } else if (N == 1) {
+      const int v = _cells[k].val();
+      obs.on_assign(k, v);
+      for (int i = 0; i < _neighbors[k].size(); i++) {
+         if (!eliminate(_neighbors[k][i], v, obs)) return false;
+      }
+   }
+   for (int i = 0; i < _groups_of[k].size(); i++) {
+      const int x = _groups_of[k][i];
+      int n = 0, ks;
+      for (int j = 0; j < 9; j++) {
+         const int p = _group[x][j];
+         if (_cells[p].is_on(val)) {
+            n++, ks = p;
+         }
+      }
+      if (n == 0) {
+         obs.on_contradiction(k);
+         return false;
+      } else if (n == 1) {
+         if (!assign(ks, val, obs)) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+int Sudoku::least_count() const {
+   int k = -1, min;
+   for (int i = 0; i < _cells.size(); i++) {
+      const int m = _cells[i].count();
+      if (m > 1 && (k == -1 || m < min)) {
+         min = m, k = i;
+      }
+   }
+   return k;
+}
+
+template <class Observer>
+Sudoku::Sudoku(string s, Observer& obs)
+  : _cells(81)
+{
+   int k = 0;
+   for (int i = 0; i < s.size(); i++) {
+      if (s[i] >= '1' && s[i] <= '9') {
+         if (!assign(k, s[i] - '0', obs)) {
+            cerr << "error" << endl;
+            return;
+         }
+         k++;
+      } else if (s[i] == '0' || s[i] == '.') {
+         k++;
+      }
+   }
+}
+
+template <class Observer>
+unique_ptr<Sudoku> solve(unique_ptr<Sudoku> S, Observer& obs, int node) {
+   if (S == nullptr || S->is_solved()) {
+      return S;
+   }
+   int k = S->least_count();
+   Possible p = S->possible(k);
+   for (int i = 1; i <= 9; i++) {
+      if (p.is_on(i)) {
+         const int child = obs.on_branch(node, k, i);
+         unique_ptr<Sudoku> S1(new Sudoku(*S));
+         if (S1->assign(k, i, obs)) {
+            if (auto S2 = solve(std::move(S1), obs, child)) {
+               return S2;
+            }
+         }
+         obs.on_backtrack(child, k, i);
+      }
+   }
+   return {};
+}
+
+// ==================================== DSATUR Colouring ==========================================
+
+// A sudoku is a colouring of its constraint graph: each cell is a vertex, cells that may not hold the same digit are
+// joined by an edge, and the digits are the colours. The graph is built from cliques (units), so irregular and
+// overlapping variants are described by adding or replacing units, e.g. the two diagonals of Sudoku X.
+class ConstraintGraph {
+   int _colours;
+   vector< vector<int> > _adjacent;
+public:
+   ConstraintGraph(int vertices, int colours) : _colours(colours), _adjacent(vertices) {}
+
+   // The standard 9x9 grid: 81 vertices of degree 20, joined by rows, columns and boxes.
+   static ConstraintGraph sudoku();
+
+   // Joins every pair of the given vertices, so that they must all have different colours.
+   void add_clique(const vector<int>& vertices);
+
+   int vertices() const { return _adjacent.size(); }
+   int colours() const { return _colours; }
+   const vector<int>& adjacent(int v) const { return _adjacent[v]; }
+};
+
+ConstraintGraph ConstraintGraph::sudoku() {
+   ConstraintGraph g(81, 9);
+   for (int i = 0; i < 9; i++) {
+      vector<int> row, col, box;
+      for (int j = 0; j < 9; j++) {
+         row.push_back(i*9 + j);
+         col.push_back(j*9 + i);
+         box.push_back(((i/3)*3 + j/3)*9 + (i%3)*3 + j%3);
+      }
+      g.add_clique(row);
+      g.add_clique(col);
+      g.add_clique(box);
+   }
+   return g;
+}
+
+void ConstraintGraph::add_clique(const vector<int>& vertices) {
+   for (int a : vertices) {
+      for (int b : vertices) {
+         if (a != b && find(_adjacent[a].begin(), _adjacent[a].end(), b) == _adjacent[a].end()) {
+            _adjacent[a].push_back(b);
+         }
+      }
+   }
+}
+
+// Exact colouring by DSATUR search (Brelaz, 1979): the next vertex to colour is always one whose coloured neighbours
+// already use the most distinct colours (the highest saturation degree), and its free colours are tried in order.
+// For a sudoku this is the cell with the fewest candidates, as in the Norvig solver, but found without scanning the
+// grid: the colours used around each vertex are kept as a bitset, and the uncoloured vertices are kept in buckets by
+// saturation degree, so colouring a vertex only moves the neighbours that gain a new colour up one bucket. A colouring
+// that leaves an uncoloured vertex with every colour used around it fails at once. Up to 32 colours are supported.
+class DsaturSolver {
+   const ConstraintGraph& _g;
+   const int _colours;
+   const uint32_t _all;
+   vector<int> _colour;         // Colour of each vertex, -1 if uncoloured.
+   vector<uint32_t> _saturation;  // Colours used by the coloured neighbours of each vertex.
+   vector<uint8_t> _uses;       // _uses[v*colours + c]: number of coloured neighbours of v with colour c.
+
+   // Uncoloured vertices in doubly linked lists, one per saturation degree. Buckets above _top are empty.
+   vector<int> _head, _next, _prev;
+   int _top = 0;
+
+   void link(int v);
+   void unlink(int v);
+   int  select();
+   template <class Observer>
+   bool colour(int v, int c, Observer& obs);
+   void uncolour(int v, int c);
+
+public:
+   explicit DsaturSolver(const ConstraintGraph& g);
+
+   // Colours the graph with the given vertices precoloured (-1 for uncoloured). Returns true if a colouring was found.
+   template <class Observer>
+   bool solve(const vector<int>& given, Observer& obs);
+
+   template <class Observer>
+   bool search(Observer& obs, int node);
+
+   int colour(int v) const { return _colour[v]; }
+};
+
+DsaturSolver::DsaturSolver(const ConstraintGraph& g)
+  : _g(g), _colours(g.colours()), _all(g.colours() == 32 ? ~0u : (1u << g.colours()) - 1),
+    _colour(g.vertices(), -1), _saturation(g.vertices(), 0), _uses(g.vertices() * g.colours(), 0),
+    _head(g.colours() + 1, -1), _next(g.vertices()), _prev(g.vertices())
+{
+   for (int v = g.vertices() - 1; v >= 0; v--) link(v);
+}
+
+// Adds an uncoloured vertex to the front of the bucket of its saturation degree.
+void DsaturSolver::link(int v) {
+   const int s = __builtin_popcount(_saturation[v]);
+   _prev[v] = -1;
+   _next[v] = _head[s];
+   if (_head[s] >= 0) _prev[_head[s]] = v;
+   _head[s] = v;
+   _top = max(_top, s);
+}
+
+void DsaturSolver::unlink(int v) {
+   const int s = __builtin_popcount(_saturation[v]);
+   if (_prev[v] >= 0) _next[_prev[v]] = _next[v];
+   else _head[s] = _next[v];
+   if (_next[v] >= 0) _prev[_next[v]] = _prev[v];
+}
+
+// Returns an uncoloured vertex of the highest saturation degree, or -1 if every vertex is coloured.
+int DsaturSolver::select() {
+   while (_top > 0 && _head[_top] < 0) _top--;
+   return _head[_top];
+}
+
+// Colours vertex v with colour c, updating the saturation of its neighbours.
+// Returns false if an uncoloured neighbour is left with no free colour.
+template <class Observer>
+bool DsaturSolver::colour(int v, int c, Observer& obs) {
+   unlink(v);
+   _colour[v] = c;
+   obs.on_assign(v, c + 1);
+   int wiped = -1;
+   for (int u : _g.adjacent(v)) {
+      if (_uses[u*_colours + c]++ > 0) continue;
+      if (_colour[u] < 0) {
+         unlink(u);
+         _saturation[u] |= 1u << c;
+         link(u);
+         obs.on_eliminate(u, c + 1);
+         if (_saturation[u] == _all && wiped < 0) wiped = u;
+      } else {
+         _saturation[u] |= 1u << c;
+      }
+   }
+   if (wiped >= 0) obs.on_contradiction(wiped);
+   return wiped < 0;
+}
+
+// Undoes colour(v, c).
+void DsaturSolver::uncolour(int v, int c) {
+   for (int u : _g.adjacent(v)) {
+      if (--_uses[u*_colours + c] > 0) continue;
+      if (_colour[u] < 0) {
+         unlink(u);
+         _saturation[u] &= ~(1u << c);
+         link(u);
+      } else {
+         _saturation[u] &= ~(1u << c);
+      }
+   }
+   _colour[v] = -1;
+   link(v);
+}
+
+// The root node is opened before the givens are coloured, so the saturation updates they make are counted against it.
+template <class Observer>
+bool DsaturSolver::solve(const vector<int>& given, Observer& obs) {
+   const int root = obs.on_branch(-1, -1, 0);
+   bool consistent = true;
+   for (int v = 0; v < _g.vertices() && consistent; v++) {
+      if (given[v] >= 0) {
+         if (_saturation[v] >> given[v] & 1) {
+            obs.on_contradiction(v);
+            consistent = false;
+         } else {
+            consistent = colour(v, given[v], obs);
+         }
+      }
+   }
+   return consistent && search(obs, root);
+}
+
+template <class Observer>
+bool DsaturSolver::search(Observer& obs, int node) {
+   const int v = select();
+   if (v < 0) {
+      return true;
+   }
+   uint32_t free = _all & ~_saturation[v];
+   while (free) {
+      const int c = __builtin_ctz(free);
+      free &= free - 1;
+      const int child = obs.on_branch(node, v, c + 1);
+      if (colour(v, c, obs) && search(obs, child)) {
+         return true;
+      }
+      uncolour(v, c);
+      obs.on_backtrack(child, v, c + 1);
+   }
+   return false;
+}
+
+// ===================================== Engine Table =============================================
+
+// Solves the puzzle given as one line of the data files (81 characters, '0' or '.' for empty cells)
+// with the backtracking algorithm. Returns true if a solution was found.
+template <class Observer>
+bool run_backtracking(const string& puzzle, Observer& obs) {
+   int grid[9][9];
+   for (int k = 0; k < 81; k++) {
+      grid[k/9][k%9] = (puzzle[k] >= '1' && puzzle[k] <= '9') ? puzzle[k] - '0' : UNASSIGNED;
+   }
+   const int root = obs.on_branch(-1, -1, 0);
+   return SolveSudoku(grid, obs, root);
+}
+
+// Solves the puzzle with the Norvig solver. Returns true if a solution was found.
+// The root node is opened before the givens are set up, so the eliminations they make are counted against it.
+template <class Observer>
+bool run_norvig(const string& puzzle, Observer& obs) {
+   const int root = obs.on_branch(-1, -1, 0);
+   unique_ptr<Sudoku> S(new Sudoku(puzzle, obs));
+   return solve(std::move(S), obs, root) != nullptr;
+}
+
+// Solves the puzzle by DSATUR colouring of the sudoku constraint graph. Returns true if a solution was found.
+template <class Observer>
+bool run_dsatur(const string& puzzle, Observer& obs) {
+   static const ConstraintGraph graph = ConstraintGraph::sudoku();
+   vector<int> given(81);
+   for (int k = 0; k < 81; k++) {
+      given[k] = (puzzle[k] >= '1' && puzzle[k] <= '9') ? puzzle[k] - '1' : -1;
+   }
+   DsaturSolver S(graph);
+   return S.solve(given, obs);
+}
+
+template <bool (*Run)(const string&, NullObserver&)>
+bool run_unobserved(const string& puzzle) {
+   NullObserver obs;
+   return Run(puzzle, obs);
+}
+
+typedef ObserverPair<SolveStats, TraceObserver> TracedStats;
+typedef ObserverPair<SolveStats, TreeRecorder> RecordedStats;
+
+template <bool (*Run)(const string&, TracedStats&)>
+bool run_traced(const string& puzzle, SolveStats& stats) {
+   TraceObserver trace;
+   TracedStats obs{stats, trace};
+   return Run(puzzle, obs);
+}
+
+template <bool (*Run)(const string&, RecordedStats&)>
+bool run_recorded(const string& puzzle, SolveStats& stats, TreeRecorder& rec) {
+   RecordedStats obs{stats, rec};
+   const bool solved = Run(puzzle, obs);
+   rec.finish(solved);
+   return solved;
+}
+
+// Every engine the harness can benchmark. Bundles refer to engines by name.
+// time: solves with no observer, so that the engine runs without any instrumentation (used for all timings).
+// run: solves with the counters observing.
+// trace: solves while printing every branch and backtrack.
+// record: solves while recording the search tree.
+struct Engine {
+   const char* name;
+   bool (*time)(const string& puzzle);
+   bool (*run)(const string& puzzle, SolveStats& stats);
+   bool (*trace)(const string& puzzle, SolveStats& stats);
+   bool (*record)(const string& puzzle, SolveStats& stats, TreeRecorder& rec);
+};
+
+const Engine engines[] = {
+   {"backtracking", run_unobserved<run_backtracking<NullObserver> >, run_backtracking<SolveStats>,
+                    run_traced<run_backtracking<TracedStats> >, run_recorded<run_backtracking<RecordedStats> >},
+   {"norvig", run_unobserved<run_norvig<NullObserver> >, run_norvig<SolveStats>,
+              run_traced<run_norvig<TracedStats> >, run_recorded<run_norvig<RecordedStats> >},
+   {"dsatur", run_unobserved<run_dsatur<NullObserver> >, run_dsatur<SolveStats>,
+              run_traced<run_dsatur<TracedStats> >, run_recorded<run_dsatur<RecordedStats> >},
+};
+
+const Engine* find_engine(const string& name) {
+   for (const Engine& e : engines) {
+      if (name == e.name) return &e;
+   }
+   return nullptr;
+}
+
+// ================================= Slowest Solve Capture ========================================
+
+// One solve that is a candidate for the slowest-K list, holding everything needed to replay it.
+struct SlowSolve {
+   double time;
+   string engine;
+   string file;
+   int id;
+   unsigned seed;
+   SolveStats stats;
+   string puzzle;
+
+   bool operator>(const SlowSolve& o) const { return time > o.time; }
+};
+
+// Keeps the K slowest solves offered to it in a bounded min-heap, so that the fastest of the
+// current K sits on top and is the only one that needs to be compared against a new solve.
+// Each worker keeps its own instance (nothing here is shared), and the lists of several
+// workers are combined with merge().
+class SlowestSolves {
+   size_t _k;
+   priority_queue<SlowSolve, vector<SlowSolve>, greater<SlowSolve> > _heap;
+public:
+   explicit SlowestSolves(size_t k) : _k(k) {}
+
+   void offer(const SlowSolve& s) {
+      if (_k == 0) return;
+      if (_heap.size() < _k) {
+         _heap.push(s);
+      } else if (s.time > _heap.top().time) {
+         _heap.pop();
+         _heap.push(s);
+      }
+   }
+
+   void merge(const SlowestSolves& other) {
+      auto copy = other._heap;
+      while (!copy.empty()) {
+         offer(copy.top());
+         copy.pop();
+      }
+   }
+
+   // Returns the solves kept so far, slowest first.
+   vector<SlowSolve> sorted() const {
+      auto copy = _heap;
+      vector<SlowSolve> v;
+      while (!copy.empty()) {
+         v.push_back(copy.top());
+         copy.pop();
+      }
+      reverse(v.begin(), v.end());
+      return v;
+   }
+};
+
+// Writes one bundle per line in the form:
+// engine,file,puzzle number,seed,time,nodes,backtracks,propagations,puzzle
+void write_bundle(ostream& o, const SlowSolve& s) {
+   o << s.engine << "," << s.file << "," << s.id << "," << s.seed << "," << fixed << s.time << ","
+     << s.stats.nodes << "," << s.stats.backtracks << "," << s.stats.propagations << "," << s.puzzle << "\n";
+}
+
+bool read_bundle(const string& line, SlowSolve& s) {
+   stringstream ss(line);
+   string field;
+   vector<string> f;
+   while (getline(ss, field, ',')) f.push_back(field);
+   if (f.size() != 9) return false;
+   s.engine = f[0];
+   s.file = f[1];
+   s.id = stoi(f[2]);
+   s.seed = stoul(f[3]);
+   s.time = stod(f[4]);
+   s.stats.nodes = stol(f[5]);
+   s.stats.backtracks = stol(f[6]);
+   s.stats.propagations = stol(f[7]);
+   s.puzzle = f[8];
+   return true;
+}
+
+// Re-runs every bundle in the file with tracing turned on. Both engines are deterministic, so the
+// counters of the replay must match the recorded ones exactly; any difference is reported.
+int replay(const string& bundle_file) {
+   ifstream in(bundle_file);
+   if (!in) {
+      cerr << "Could not open " << bundle_file << endl;
+      return 1;
+   }
+   string line;
+   int mismatches = 0;
+   while (getline(in, line)) {
+      SlowSolve s;
+      if (!read_bundle(line, s)) continue;
+      const Engine* e = find_engine(s.engine);
+      if (e == nullptr) {
+         cerr << "Unknown engine " << s.engine << endl;
+         continue;
+      }
+      cout << "=== " << s.engine << " " << s.file << " #" << s.id << " seed " << s.seed << endl;
+      SolveStats stats;
+      e->trace(s.puzzle, stats);
+      const bool same = stats.nodes == s.stats.nodes && stats.backtracks == s.stats.backtracks
+                        && stats.propagations == s.stats.propagations;
+      cout << "=== nodes " << stats.nodes << " backtracks " << stats.backtracks
+           << " propagations " << stats.propagations << (same ? " (matches bundle)" : " (DIFFERS FROM BUNDLE)") << endl;
+      if (!same) mismatches++;
+   }
+   return mismatches == 0 ? 0 : 1;
+}
+
+// ================================== Search Tree Export ==========================================
+
+// Writes the nodes exactly as they are held in memory, after a small header:
+// "SDKT", node count (uint32), truncated flag (uint32), then 12 bytes per node.
+void write_tree_binary(const string& path, const TreeRecorder& rec) {
+   ofstream o(path, ios::binary);
+   const uint32_t count = rec.nodes().size(), truncated = rec.truncated();
+   o.write("SDKT", 4);
+   o.write((const char*)&count, sizeof count);
+   o.write((const char*)&truncated, sizeof truncated);
+   o.write((const char*)rec.nodes().data(), count * sizeof(TreeNode));
+}
+
+// Number of nodes in the subtree below (and including) each node. Since children
+// are always stored after their parent, one backwards pass is enough.
+vector<long> subtree_sizes(const vector<TreeNode>& nodes) {
+   vector<long> size(nodes.size(), 1);
+   for (size_t i = nodes.size(); i-- > 1; ) {
+      if (nodes[i].parent >= 0) size[nodes[i].parent] += size[i];
+   }
+   return size;
+}
+
+string branch_label(const TreeNode& n) {
+   if (n.cell == 255) return "root";
+   return "r" + to_string(n.cell / 9 + 1) + "c" + to_string(n.cell % 9 + 1) + "=" + to_string(n.digit);
+}
+
+void write_tree_dot(const string& path, const TreeRecorder& rec) {
+   const vector<TreeNode>& nodes = rec.nodes();
+   const vector<long> size = subtree_sizes(nodes);
+   ofstream o(path);
+   o << "digraph search_tree {\n  node [shape=box, fontsize=10];\n";
+   for (size_t i = 0; i < nodes.size(); i++) {
+      const char* colour = nodes[i].result == NODE_SOLVED ? "palegreen"
+                         : nodes[i].result == NODE_FAILED ? "lightpink" : "white";
+      o << "  n" << i << " [label=\"" << branch_label(nodes[i]) << "\\nprop " << nodes[i].propagations
+        << "\\nsubtree " << size[i] << "\", style=filled, fillcolor=" << colour << "];\n";
+      if (nodes[i].parent >= 0) o << "  n" << nodes[i].parent << " -> n" << i << ";\n";
+   }
+   o << "}\n";
+}
+
+// Writes a summary of the tree (size, depth, how many failed leaves there are at each depth, and the
+// subtree size of every child of the root) followed by the full node list.
+void write_tree_json(const string& path, const string& engine, const string& puzzle, const TreeRecorder& rec) {
+   const vector<TreeNode>& nodes = rec.nodes();
+   const vector<long> size = subtree_sizes(nodes);
+
+   // A failed leaf is a failed node with no recorded children.
+   vector<bool> has_child(nodes.size(), false);
+   for (const TreeNode& n : nodes) {
+      if (n.parent >= 0) has_child[n.parent] = true;
+   }
+   map<int, long> failure_depths;
+   int max_depth = 0;
+   for (size_t i = 0; i < nodes.size(); i++) {
+      max_depth = max(max_depth, (int)nodes[i].depth);
+      if (nodes[i].result == NODE_FAILED && !has_child[i]) failure_depths[nodes[i].depth]++;
+   }
+
+   ofstream o(path);
+   o << "{\n  \"engine\": \"" << engine << "\",\n  \"puzzle\": \"" << puzzle << "\",\n"
+     << "  \"nodes\": " << nodes.size() << ",\n  \"truncated\": " << (rec.truncated() ? "true" : "false") << ",\n"
+     << "  \"max_depth\": " << max_depth << ",\n  \"failure_depths\": {";
+   bool first = true;
+   for (auto& d : failure_depths) {
+      o << (first ? "" : ", ") << "\"" << d.first << "\": " << d.second;
+      first = false;
+   }
+   o << "},\n  \"root_subtrees\": [";
+   first = true;
+   for (size_t i = 1; i < nodes.size(); i++) {
+      if (nodes[i].parent != 0) continue;
+      o << (first ? "" : ", ") << "{\"branch\": \"" << branch_label(nodes[i]) << "\", \"size\": " << size[i] << "}";
+      first = false;
+   }
+   o << "],\n  \"tree\": [\n";
+   for (size_t i = 0; i < nodes.size(); i++) {
+      const TreeNode& n = nodes[i];
+      o << "    {\"id\": " << i << ", \"parent\": " << n.parent << ", \"cell\": " << (n.cell == 255 ? -1 : (int)n.cell)
+        << ", \"digit\": " << (int)n.digit << ", \"depth\": " << (int)n.depth
+        << ", \"result\": \"" << (n.result == NODE_SOLVED ? "solved" : n.result == NODE_FAILED ? "failed" : "open")
+        << "\", \"propagations\": " << n.propagations << ", \"subtree\": " << size[i] << "}"
+        << (i + 1 < nodes.size() ? ",\n" : "\n");
+   }
+   o << "  ]\n}\n";
+}
+
+// Records the search tree the given engine builds for one puzzle of a data file and exports it.
+int export_tree(const string& engine, const string& file, int id, const string& prefix, size_t max_nodes) {
+   const Engine* e = find_engine(engine);
+   if (e == nullptr) {
+      cerr << "Unknown engine " << engine << endl;
+      return 1;
+   }
+   ifstream in(file);
+   string line;
+   for (int i = 0; i < id && getline(in, line); i++) {}
+   if (!in) {
+      cerr << "Could not read puzzle " << id << " of " << file << endl;
+      return 1;
+   }
+
+   TreeRecorder rec(max_nodes);
+   SolveStats stats;
+   e->record(line, stats, rec);
+
+   write_tree_binary(prefix + ".bin", rec);
+   write_tree_dot(prefix + ".dot", rec);
+   write_tree_json(prefix + ".json", engine, line, rec);
+   cout << "Recorded " << rec.nodes().size() << " nodes" << (rec.truncated() ? " (truncated)" : "") << endl;
+   return 0;
+}
+
+// ===================================== HDR Histogram ============================================
+
+// High dynamic range histogram of integer values (here nanoseconds), following the bucket layout of HdrHistogram:
+// values are grouped into buckets covering powers of two, each split into enough linear sub-buckets to keep the
+// given number of significant decimal digits. Recording is a couple of shifts and an increment, so each worker
+// records into its own histogram without locking, and histograms with the same layout are merged by adding counts.
+// Histograms can be written to and read back from the standard HdrHistogram log format, so that histograms
+// from separate processes can be merged as well.
+class HdrHistogram {
+   int64_t _lowest, _highest;
+   int _significant_figures;
+   int _unit_magnitude, _sub_bucket_half_count_magnitude;
+   int64_t _sub_bucket_count, _sub_bucket_half_count, _sub_bucket_mask;
+   int _bucket_count;
+   vector<int64_t> _counts;
+   int64_t _total = 0, _min = INT64_MAX, _max = 0;
+
+   int bucket_index(int64_t v) const {
+      const int pow2ceiling = 64 - __builtin_clzll(v | _sub_bucket_mask);
+      return pow2ceiling - _unit_magnitude - (_sub_bucket_half_count_magnitude + 1);
+   }
+   int sub_bucket_index(int64_t v, int bucket) const { return (int)(v >> (bucket + _unit_magnitude)); }
+   size_t counts_index(int bucket, int sub) const {
+      return ((size_t)(bucket + 1) << _sub_bucket_half_count_magnitude) + (sub - _sub_bucket_half_count);
+   }
+   size_t counts_index_of(int64_t v) const {
+      const int bucket = bucket_index(v);
+      return counts_index(bucket, sub_bucket_index(v, bucket));
+   }
+   int64_t value_at(size_t index) const {
+      int bucket = (int)(index >> _sub_bucket_half_count_magnitude) - 1;
+      int64_t sub = (index & (_sub_bucket_half_count - 1)) + _sub_bucket_half_count;
+      if (bucket < 0) {
+         sub -= _sub_bucket_half_count;
+         bucket = 0;
+      }
+      return sub << (bucket + _unit_magnitude);
+   }
+   // Largest value that would be recorded in the same count as v.
+   int64_t highest_equivalent(int64_t v) const {
+      const int bucket = bucket_index(v);
+      const int sub = sub_bucket_index(v, bucket);
+      const int adjusted = sub >= _sub_bucket_count ? bucket + 1 : bucket;
+      const int64_t lowest = (int64_t)sub << (bucket + _unit_magnitude);
+      return lowest + ((int64_t)1 << (_unit_magnitude + adjusted)) - 1;
+   }
+
+public:
+   HdrHistogram(int64_t lowest, int64_t highest, int significant_figures)
+     : _lowest(lowest), _highest(highest), _significant_figures(significant_figures) {
+      const int64_t largest_single_unit = 2 * (int64_t)pow(10, significant_figures);
+      const int sub_bucket_count_magnitude = (int)ceil(log2((double)largest_single_unit));
+      _sub_bucket_half_count_magnitude = max(sub_bucket_count_magnitude, 1) - 1;
+      _unit_magnitude = (int)floor(log2((double)lowest));
+      _sub_bucket_count = (int64_t)1 << (_sub_bucket_half_count_magnitude + 1);
+      _sub_bucket_half_count = _sub_bucket_count / 2;
+      _sub_bucket_mask = (_sub_bucket_count - 1) << _unit_magnitude;
+
+      int64_t smallest_untrackable = _sub_bucket_count << _unit_magnitude;
+      _bucket_count = 1;
+      while (smallest_untrackable <= highest) {
+         if (smallest_untrackable > INT64_MAX / 2) {
+            _bucket_count++;
+            break;
+         }
+         smallest_untrackable <<= 1;
+         _bucket_count++;
+      }
+      _counts.assign((_bucket_count + 1) * _sub_bucket_half_count, 0);
+   }
+
+   // Histogram of solve times from 1 nanosecond to 1000 seconds to 3 significant digits.
+   static HdrHistogram nanoseconds() { return HdrHistogram(1, 1000000000000LL, 3); }
+
+   // Records a value, clamping it to the trackable range.
+   void record(int64_t v) {
+      v = min(max(v, (int64_t)0), _highest);
+      _counts[counts_index_of(v)]++;
+      _total++;
+      _min = min(_min, v);
+      _max = max(_max, v);
+   }
+
+   // Adds the counts of another histogram with the same layout.
+   void merge(const HdrHistogram& o) {
+      for (size_t i = 0; i < _counts.size(); i++) _counts[i] += o._counts[i];
+      _total += o._total;
+      _min = min(_min, o._min);
+      _max = max(_max, o._max);
+   }
+
+   // Value below which the given percentage of the recorded values fall (to the precision of the histogram).
+   int64_t percentile(double p) const {
+      if (_total == 0) return 0;
+      const int64_t target = max((int64_t)1, (int64_t)(p / 100 * _total + 0.5));
+      int64_t seen = 0;
+      for (size_t i = 0; i < _counts.size(); i++) {
+         seen += _counts[i];
+         if (seen >= target) return min(highest_equivalent(value_at(i)), _max);
+      }
+      return _max;
+   }
+
+   int64_t total() const { return _total; }
+   int64_t max_value() const { return _max; }
+
+   // Encodes the histogram in the compressed V2 format of HdrHistogram and returns it in base64, as used in
+   // histogram logs. The counts up to the largest recorded value are written as ZigZag LEB128 variable-length
+   // integers, with runs of zeros written as a single negative count, after a 40-byte big-endian header.
+   // The whole encoding is then deflated with zlib behind an 8-byte header.
+   string encode() const {
+      vector<uint8_t> payload;
+      const size_t limit = _total ? counts_index_of(_max) + 1 : 0;
+      for (size_t i = 0; i < limit; ) {
+         int64_t value = _counts[i++];
+         if (value == 0) {
+            int64_t zeros = 1;
+            while (i < limit && _counts[i] == 0) zeros++, i++;
+            if (zeros > 1) value = -zeros;
+         }
+         uint64_t z = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+         for (int b = 0; b < 8 && z >= 0x80; b++, z >>= 7) payload.push_back((uint8_t)(z | 0x80));
+         payload.push_back((uint8_t)z);
+      }
+
+      vector<uint8_t> raw;
+      auto put = [&](uint64_t v, int bytes) {
+         for (int b = bytes - 1; b >= 0; b--) raw.push_back((uint8_t)(v >> (8 * b)));
+      };
+      const double ratio = 1.0;
+      uint64_t ratio_bits;
+      memcpy(&ratio_bits, &ratio, 8);
+      put(0x1c849313, 4);              // V2 encoding cookie (with the 0x10 flag for ZigZag LEB128 counts).
+      put(payload.size(), 4);
+      put(0, 4);                       // Normalizing index offset.
+      put(_significant_figures, 4);
+      put(_lowest, 8);
+      put(_highest, 8);
+      put(ratio_bits, 8);              // Integer to double value conversion ratio.
+      raw.insert(raw.end(), payload.begin(), payload.end());
+
+      uLongf compressed_size = compressBound(raw.size());
+      vector<uint8_t> out(8 + compressed_size);
+      compress2(out.data() + 8, &compressed_size, raw.data(), raw.size(), 9);
+      out.resize(8 + compressed_size);
+      const uint32_t header[2] = {0x1c849314, (uint32_t)compressed_size};   // V2 compressed encoding cookie.
+      for (int h = 0; h < 2; h++) {
+         for (int b = 0; b < 4; b++) out[4*h + b] = (uint8_t)(header[h] >> (24 - 8 * b));
+      }
+
+      static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+      string base64;
+      for (size_t i = 0; i < out.size(); i += 3) {
+         const uint32_t n = out[i] << 16 | (i + 1 < out.size() ? out[i + 1] << 8 : 0) | (i + 2 < out.size() ? out[i + 2] : 0);
+         base64 += alphabet[n >> 18 & 63];
+         base64 += alphabet[n >> 12 & 63];
+         base64 += i + 1 < out.size() ? alphabet[n >> 6 & 63] : '=';
+         base64 += i + 2 < out.size() ? alphabet[n & 63] : '=';
+      }
+      return base64;
+   }
+
+   // Decodes a histogram written by encode() (or by any HdrHistogram library) and adds its counts to this one.
+   // Returns false if it cannot be decoded or does not have the same layout as this histogram.
+   bool merge_encoded(const string& base64) {
+      vector<uint8_t> in;
+      uint32_t bits = 0;
+      int n = 0;
+      for (char c : base64) {
+         int v;
+         if (c >= 'A' && c <= 'Z') v = c - 'A';
+         else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+         else if (c >= '0' && c <= '9') v = c - '0' + 52;
+         else if (c == '+') v = 62;
+         else if (c == '/') v = 63;
+         else continue;
+         bits = bits << 6 | v;
+         if ((n += 6) >= 8) in.push_back((uint8_t)(bits >> (n -= 8)));
+      }
+      auto get = [](const uint8_t* p, int bytes) {
+         uint64_t v = 0;
+         for (int b = 0; b < bytes; b++) v = v << 8 | p[b];
+         return v;
+      };
+      // The low byte of each cookie carries flags, which are ignored when comparing.
+      if (in.size() < 8 || (get(in.data(), 4) & ~0xF0ULL) != 0x1c849304) return false;
+
+      uLongf raw_size = 40 + 9 * _counts.size();
+      vector<uint8_t> raw(raw_size);
+      if (uncompress(raw.data(), &raw_size, in.data() + 8, in.size() - 8) != Z_OK || raw_size < 40) return false;
+      if ((get(&raw[0], 4) & ~0xF0ULL) != 0x1c849303 || (int)get(&raw[12], 4) != _significant_figures
+          || (int64_t)get(&raw[16], 8) != _lowest || (int64_t)get(&raw[24], 8) != _highest) return false;
+
+      const size_t end = min((size_t)raw_size, (size_t)(40 + get(&raw[4], 4)));
+      size_t index = 0;
+      for (size_t p = 40; p < end && index < _counts.size(); ) {
+         uint64_t z = 0;
+         int shift = 0;
+         for (int b = 0; b < 9 && p < end; b++, shift += 7) {
+            const uint8_t byte = raw[p++];
+            if (b == 8) {
+               z |= (uint64_t)byte << 56;
+               break;
+            }
+            z |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+         }
+         const int64_t value = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+         if (value < 0) {
+            index += -value;
+         } else {
+            if (value > 0) {
+               const int64_t v = value_at(index);
+               _total += value;
+               _min = min(_min, v);
+               _max = max(_max, highest_equivalent(v));
+            }
+            _counts[index++] += value;
+         }
+      }
+      return true;
+   }
+};
+
+// Writes histograms as a standard HdrHistogram log, one tagged interval per histogram. Values are
+// in nanoseconds, and the maximum of each interval is given in seconds.
+void write_histogram_log(const string& path, double start_time, double interval,
+                         const vector<pair<string, const HdrHistogram*> >& histograms) {
+   ofstream o(path);
+   o << "#[Histogram log format version 1.3]\n";
+   o << "#[StartTime: " << fixed << setprecision(3) << start_time << " (seconds since epoch)]\n";
+   o << "#[MaxValueDivisor: 1000000000.000]\n";
+   o << "\"StartTimestamp\",\"Interval_Length\",\"Interval_Max\",\"Interval_Compressed_Histogram\"\n";
+   for (const auto& h : histograms) {
+      string tag = h.first;
+      replace(tag.begin(), tag.end(), ' ', '_');
+      replace(tag.begin(), tag.end(), ',', '_');
+      o << "Tag=" << tag << "," << setprecision(3) << 0.0 << "," << interval << ","
+        << setprecision(9) << h.second->max_value() / 1e9 << "," << h.second->encode() << "\n";
+   }
+}
+
+// ==================================== Energy Measurement ========================================
+
+// Reads the package and DRAM energy counters of every RAPL domain exposed by powercap.
+class EnergyCounters {
+   struct Zone {
+      string path;           // Directory of the zone in /sys/class/powercap.
+      bool dram;             // DRAM domain if true, package domain otherwise.
+      double max_range;      // Value (in microjoules) at which the counter wraps around to 0.
+   };
+   vector<Zone> _zones;
+
+   static bool read_number(const string& path, double& value) {
+      ifstream in(path);
+      return (bool)(in >> value);
+   }
+
+public:
+   // Finds every package and DRAM zone whose counter can be read. Some Intel systems also expose the package
+   // counter through MMIO as "intel-rapl-mmio:0", named "package-0" like "intel-rapl:0"; those zones are skipped so
+   // that the package energy is not counted twice.
+   EnergyCounters() {
+      const string root = "/sys/class/powercap/";
+      DIR* dir = opendir(root.c_str());
+      if (dir == nullptr) return;
+      while (dirent* entry = readdir(dir)) {
+         if (strncmp(entry->d_name, "intel-rapl-mmio", 15) == 0) continue;
+         const string path = root + entry->d_name;
+         string name;
+         ifstream in(path + "/name");
+         if (!(in >> name)) continue;
+         const bool dram = name == "dram";
+         if (!dram && name.compare(0, 8, "package-") != 0) continue;
+         double energy, range;
+         if (!read_number(path + "/energy_uj", energy) || !read_number(path + "/max_energy_range_uj", range)) continue;
+         _zones.push_back({path, dram, range});
+      }
+      closedir(dir);
+   }
+
+   bool available() const { return !_zones.empty(); }
+
+   // Current value of every counter, in microjoules.
+   vector<double> snapshot() const {
+      vector<double> values;
+      for (const Zone& z : _zones) {
+         double v = 0;
+         read_number(z.path + "/energy_uj", v);
+         values.push_back(v);
+      }
+      return values;
+   }
+
+   // Package and DRAM energy in joules used between two snapshots, allowing for each counter wrapping
+   // around once (at the default power limits this takes minutes, longer than one batch).
+   void joules(const vector<double>& before, const vector<double>& after, double& package, double& dram) const {
+      package = dram = 0;
+      for (size_t i = 0; i < _zones.size(); i++) {
+         double used = after[i] - before[i];
+         if (used < 0) used += _zones[i].max_range;
+         (_zones[i].dram ? dram : package) += used / 1e6;
+      }
+   }
+};
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   Sudoku::init();
+
+   if (argc == 3 && strcmp(argv[1], "replay") == 0) {
+      return replay(argv[2]);
+   }
+   if ((argc == 6 || argc == 7) && strcmp(argv[1], "tree") == 0) {
+      return export_tree(argv[2], argv[3], stoi(argv[4]), argv[5], argc == 7 ? stoul(argv[6]) : 1000000);
+   }
+
+   // Number of slowest solves kept for each engine.
+   const size_t K = argc > 1 ? stoul(argv[1]) : 10;
+
+   const vector<string> files = {"Easy Sudokus.txt", "Medium Sudokus.txt", "Hard Sudokus.txt", "Diabolical Sudokus.txt"};
+
+   // Output header, followed by one line per engine and puzzle.
+   cout << "engine,file,puzzle,time,nodes,backtracks,propagations" << endl;
+
+   ofstream bundles("Slowest Sudokus.txt");
+
+   const EnergyCounters energy;
+   if (!energy.available()) {
+      cerr << "RAPL energy counters are not available; energy will not be reported." << endl;
+   }
+
+   // Summary of the solve times (in microseconds) and energy, output once every file has been benchmarked.
+   stringstream summary;
+   summary << "engine,file,puzzles,p50,p99,p99.9,max,package joules per puzzle,dram joules per puzzle" << endl;
+
+   // One histogram of individual solve times per engine and file.
+   vector<pair<string, HdrHistogram> > histograms;
+   const double start_time = chrono::duration<double>(chrono::system_clock::now().time_since_epoch()).count();
+   const auto run_start = chrono::steady_clock::now();
+
+   for (const Engine& e : engines) {
+
+      SlowestSolves slowest(K);
+
+      for (const string& file : files) {
+
+         // Opening the text file containing the sudoku puzzles to be solved.
+         ifstream file_to_open(file);
+         if (!file_to_open) {
+            cerr << "Could not open " << file << endl;
+            continue;
+         }
+
+         HdrHistogram histogram = HdrHistogram::nanoseconds();
+         const vector<double> energy_before = energy.snapshot();
+
+         // The puzzles of the file and the mean time taken to solve each one.
+         vector<string> lines;
+         vector<double> means;
+
+         string line;
+         while (getline(file_to_open, line)) {
+
+            // Stores the time taken to solve the sudoku puzzle 10 times.
+            double one_sudoku_time = 0;
+
+            // Each sudoku puzzle is solved 10 times to ensure measurability and repeatability.
+            // A fresh copy of the puzzle is solved each time, so every repeat does the same work.
+            for (int loop = 0; loop < 10; loop++) {
+               auto start = chrono::steady_clock::now();
+               e.time(line);
+               auto end = chrono::steady_clock::now();
+               one_sudoku_time += chrono::duration<double>(end - start).count();
+               histogram.record(chrono::duration_cast<chrono::nanoseconds>(end - start).count());
+            }
+
+            lines.push_back(line);
+            means.push_back(one_sudoku_time / 10);
+         }
+
+         // Read before the counting solves below, so that only the timed solves are measured.
+         const vector<double> energy_after = energy.snapshot();
+         const int id = lines.size();
+
+         for (int i = 0; i < id; i++) {
+
+            // The engines are deterministic, so one more solve with the counters observing gives the work done by
+            // every timed solve.
+            SolveStats stats;
+            e.run(lines[i], stats);
+
+            // Outputs the average time taken to solve one sudoku puzzle with the puzzle it belongs to.
+            cout << e.name << "," << file << "," << i + 1 << "," << fixed << means[i] << ","
+                 << stats.nodes << "," << stats.backtracks << "," << stats.propagations << endl;
+
+            slowest.offer({means[i], e.name, file, i + 1, 0, stats, lines[i]});
+         }
+
+         summary << e.name << "," << file << "," << id << "," << fixed << histogram.percentile(50) / 1e3 << ","
+                 << histogram.percentile(99) / 1e3 << "," << histogram.percentile(99.9) / 1e3 << ","
+                 << histogram.max_value() / 1e3 << ",";
+
+         // Every puzzle was solved 10 times, so the energy is divided by 10 solves per puzzle.
+         if (energy.available() && id > 0) {
+            double package, dram;
+            energy.joules(energy_before, energy_after, package, dram);
+            summary << package / (10.0 * id) << "," << dram / (10.0 * id) << endl;
+         } else {
+            summary << "n/a,n/a" << endl;
+         }
+
+         histograms.emplace_back(string(e.name) + ":" + file, histogram);
+      }
+
+      for (const SlowSolve& s : slowest.sorted()) {
+         write_bundle(bundles, s);
+      }
+   }
+
+   cerr << summary.str();
+
+   vector<pair<string, const HdrHistogram*> > tagged;
+   for (const auto& h : histograms) tagged.emplace_back(h.first, &h.second);
+   write_histogram_log("Solve Times.hlog", start_time,
+                       chrono::duration<double>(chrono::steady_clock::now() - run_start).count(), tagged);
+
+   return 0;
+}
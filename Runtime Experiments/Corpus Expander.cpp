@@ -0,0 +1,274 @@
+// Expands the Runtime Data puzzles into a larger benchmark corpus of symmetry-equivalent variants, so that tail
+// percentiles (p99.9) rest on more than 1000 solves per file.
+//
+// Each variant is the source puzzle with its bands and stacks permuted, the rows within each band and columns within
+// each stack permuted, optionally transposed, and its digits relabelled. These symmetries preserve the rules, so every
+// variant has exactly as many solutions as its source and needs the same reasoning, but the empty cells are visited in
+// a different order by engines that scan the grid row by row (such as FindUnassignedLocation in the backtracking
+// algorithm), whose effort can change considerably. The variants of a puzzle are reproducible: variant v of line l of
+// source file f is always generated from the same random seed (f, l, v). Variant 0 is the source puzzle itself.
+//
+// Corpus files are binary and little-endian:
+//   header   "SDKC", format version (uint32, 1), number of source files (uint32), then each source file name as
+//            its length (uint32) followed by its characters, then the number of records (uint64).
+//   records  49 bytes each: source line number (uint32, from 1), source file index (uint16), variant (uint16),
+//            and the 81 cells packed two to a byte (cell 2i in the low nibble, 0 for an empty cell).
+// The records of each source puzzle are consecutive, so the variants of one puzzle form one class for analysis.
+//
+// Compile with: g++ -O2 -o corpus "Corpus Expander.cpp"
+//
+// Usage:
+//   ./corpus expand <output> <variants> [files...]   writes <variants> variants of every puzzle in the files
+//                                                    (default: the four Runtime Data files).
+//   ./corpus dump <corpus> [plain]                   prints one record per line as puzzle,file,line,variant, or
+//                                                    only the puzzles, which any of the drivers here can read.
+//   ./corpus classes <corpus> <times>                reads one solve time per line, in corpus order (e.g. a driver
+//                                                    run on the plain dump), and reports the spread of times
+//                                                    within each class of variants.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+const uint32_t CORPUS_VERSION = 1;
+const size_t RECORD_SIZE = 49;
+
+// One puzzle of a corpus and the source puzzle it was generated from.
+struct CorpusRecord {
+   uint32_t line;
+   uint16_t file;
+   uint16_t variant;
+   string puzzle;    // 81 characters, '1'-'9' or '0' for an empty cell, as in the Runtime Data files.
+};
+
+struct Corpus {
+   vector<string> sources;
+   vector<CorpusRecord> records;
+};
+
+// ==================================== Grid Symmetries ===========================================
+
+// Returns variant v of an 81-character puzzle: cell (r, c) of the variant holds the relabelled digit of cell
+// (rows[r], cols[c]) of the source, with rows and columns swapped first if the variant is transposed.
+string make_variant(const string& puzzle, uint16_t file, uint32_t line, uint16_t variant) {
+   if (variant == 0) return puzzle;
+
+   seed_seq seed{(uint32_t)file, line, (uint32_t)variant};
+   mt19937 rng(seed);
+
+   // Bands (or stacks) are shuffled as blocks, then the three lines within each block.
+   auto lines = [&]() {
+      int block[3] = {0, 1, 2};
+      shuffle(block, block + 3, rng);
+      vector<int> order;
+      for (int b = 0; b < 3; b++) {
+         int within[3] = {0, 1, 2};
+         shuffle(within, within + 3, rng);
+         for (int i = 0; i < 3; i++) order.push_back(block[b]*3 + within[i]);
+      }
+      return order;
+   };
+   const vector<int> rows = lines(), cols = lines();
+   const bool transpose = rng() & 1;
+
+   char digit[10] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
+   shuffle(digit + 1, digit + 10, rng);
+
+   string out(81, '0');
+   for (int r = 0; r < 9; r++) {
+      for (int c = 0; c < 9; c++) {
+         const char v = transpose ? puzzle[cols[c]*9 + rows[r]] : puzzle[rows[r]*9 + cols[c]];
+         out[r*9 + c] = digit[v - '0'];
+      }
+   }
+   return out;
+}
+
+// ===================================== Reading and Writing ======================================
+
+void put(ofstream& out, uint64_t v, int bytes) {
+   for (int i = 0; i < bytes; i++) out.put((char)(v >> (8*i)));
+}
+
+uint64_t get(ifstream& in, int bytes) {
+   uint64_t v = 0;
+   for (int i = 0; i < bytes; i++) v |= (uint64_t)(uint8_t)in.get() << (8*i);
+   return v;
+}
+
+bool write_corpus(const string& file, const Corpus& corpus) {
+   ofstream out(file, ios::binary);
+   out.write("SDKC", 4);
+   put(out, CORPUS_VERSION, 4);
+   put(out, corpus.sources.size(), 4);
+   for (const string& s : corpus.sources) {
+      put(out, s.size(), 4);
+      out.write(s.data(), s.size());
+   }
+   put(out, corpus.records.size(), 8);
+   for (const CorpusRecord& r : corpus.records) {
+      put(out, r.line, 4);
+      put(out, r.file, 2);
+      put(out, r.variant, 2);
+      for (int k = 0; k < 81; k += 2) {
+         const int lo = r.puzzle[k] - '0';
+         const int hi = k + 1 < 81 ? r.puzzle[k + 1] - '0' : 0;
+         out.put((char)(lo | hi << 4));
+      }
+   }
+   return (bool)out;
+}
+
+bool read_corpus(const string& file, Corpus& corpus) {
+   ifstream in(file, ios::binary);
+   char magic[4];
+   if (!in.read(magic, 4) || memcmp(magic, "SDKC", 4) != 0 || get(in, 4) != CORPUS_VERSION) return false;
+   corpus.sources.resize(get(in, 4));
+   for (string& s : corpus.sources) {
+      s.resize(get(in, 4));
+      in.read(&s[0], s.size());
+   }
+   corpus.records.resize(get(in, 8));
+   for (CorpusRecord& r : corpus.records) {
+      r.line = get(in, 4);
+      r.file = get(in, 2);
+      r.variant = get(in, 2);
+      r.puzzle.assign(81, '0');
+      for (int k = 0; k < 81; k += 2) {
+         const uint8_t b = in.get();
+         r.puzzle[k] = '0' + (b & 0xF);
+         if (k + 1 < 81) r.puzzle[k + 1] = '0' + (b >> 4);
+      }
+   }
+   return (bool)in;
+}
+
+// Reads the first 81 cells of every line of a data file, with empty cells as '0'. Lines without 81 cells are
+// skipped, but still counted, so that line numbers match the file.
+vector<pair<uint32_t, string> > read_puzzles(const string& file) {
+   ifstream in(file);
+   vector<pair<uint32_t, string> > puzzles;
+   string line;
+   uint32_t number = 0;
+   while (getline(in, line)) {
+      number++;
+      string p;
+      for (char c : line) {
+         if (c >= '1' && c <= '9') p += c;
+         else if (c == '0' || c == '.') p += '0';
+         if (p.size() == 81) break;
+      }
+      if (p.size() == 81) puzzles.emplace_back(number, p);
+   }
+   return puzzles;
+}
+
+// ======================================= Commands ===============================================
+
+int expand(const string& output, int variants, const vector<string>& files) {
+   if (variants < 1 || variants > 65535) {
+      cerr << "The number of variants must be between 1 and 65535" << endl;
+      return 1;
+   }
+   Corpus corpus;
+   for (const string& file : files) {
+      const vector<pair<uint32_t, string> > puzzles = read_puzzles(file);
+      if (puzzles.empty()) {
+         cerr << "Could not read any puzzles from " << file << endl;
+         return 1;
+      }
+      const uint16_t f = corpus.sources.size();
+      corpus.sources.push_back(file);
+      for (const auto& p : puzzles) {
+         for (int v = 0; v < variants; v++) {
+            corpus.records.push_back({p.first, f, (uint16_t)v, make_variant(p.second, f, p.first, v)});
+         }
+      }
+   }
+   if (!write_corpus(output, corpus)) {
+      cerr << "Could not write " << output << endl;
+      return 1;
+   }
+   cerr << "Wrote " << corpus.records.size() << " puzzles (" << variants << " per source puzzle) to " << output << endl;
+   return 0;
+}
+
+int dump(const string& file, bool plain) {
+   Corpus corpus;
+   if (!read_corpus(file, corpus)) {
+      cerr << "Could not read corpus " << file << endl;
+      return 1;
+   }
+   for (const CorpusRecord& r : corpus.records) {
+      cout << r.puzzle;
+      if (!plain) cout << "," << corpus.sources[r.file] << "," << r.line << "," << r.variant;
+      cout << "\n";
+   }
+   return 0;
+}
+
+// For each class of variants, outputs the mean, standard deviation, minimum and maximum of the solve times and the
+// ratio of the maximum to the minimum. A ratio near 1 means the engine is insensitive to the order of the cells.
+int classes(const string& file, const string& times_file) {
+   Corpus corpus;
+   if (!read_corpus(file, corpus)) {
+      cerr << "Could not read corpus " << file << endl;
+      return 1;
+   }
+   ifstream in(times_file);
+   vector<double> times;
+   double t;
+   while (in >> t) times.push_back(t);
+   if (times.size() != corpus.records.size()) {
+      cerr << "Expected " << corpus.records.size() << " times, read " << times.size() << endl;
+      return 1;
+   }
+
+   cout << "file,line,variants,mean,sd,min,max,max/min" << endl;
+   double total_cv = 0;
+   long class_count = 0;
+   for (size_t i = 0; i < times.size();) {
+      size_t j = i;
+      double sum = 0, sum_sq = 0, lo = times[i], hi = times[i];
+      for (; j < times.size() && corpus.records[j].file == corpus.records[i].file
+             && corpus.records[j].line == corpus.records[i].line; j++) {
+         sum += times[j], sum_sq += times[j] * times[j];
+         lo = min(lo, times[j]), hi = max(hi, times[j]);
+      }
+      const double n = j - i, mean = sum / n;
+      const double sd = n > 1 ? sqrt(max(0.0, (sum_sq - n * mean * mean) / (n - 1))) : 0;
+      cout << corpus.sources[corpus.records[i].file] << "," << corpus.records[i].line << "," << j - i << "," << fixed
+           << mean << "," << sd << "," << lo << "," << hi << "," << (lo > 0 ? hi / lo : 0) << endl;
+      if (mean > 0) total_cv += sd / mean, class_count++;
+      i = j;
+   }
+   cerr << "Mean coefficient of variation within a class: " << total_cv / max(1L, class_count) << endl;
+   return 0;
+}
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   if (argc >= 4 && strcmp(argv[1], "expand") == 0) {
+      vector<string> files(argv + 4, argv + argc);
+      if (files.empty()) files = {"Easy Sudokus.txt", "Medium Sudokus.txt", "Hard Sudokus.txt", "Diabolical Sudokus.txt"};
+      return expand(argv[2], stoi(argv[3]), files);
+   }
+   if (argc >= 3 && strcmp(argv[1], "dump") == 0) {
+      return dump(argv[2], argc > 3 && strcmp(argv[3], "plain") == 0);
+   }
+   if (argc >= 4 && strcmp(argv[1], "classes") == 0) {
+      return classes(argv[2], argv[3]);
+   }
+
+   cerr << "Usage: " << argv[0] << " expand <output> <variants> [files...] | dump <corpus> [plain]"
+        << " | classes <corpus> <times>" << endl;
+   return 1;
+}
@@ -0,0 +1,301 @@
+// Backtracking algorithm from "Backtracking Algorithm.cpp" (https://www.geeksforgeeks.org/sudoku-backtracking-7/)
+// extended with forward checking and conflict-directed backjumping (the FC-CBJ algorithm of Prosser, 1993).
+//
+// The empty cells are still filled in the same order as FindUnassignedLocation visits them (row by row) and
+// the digits are still tried from 1 to 9, so the algorithm stays a minimal baseline. The differences are:
+// - Forward checking: when a digit is placed, it is removed from the remaining digits of every empty peer, and the
+//   placement is rejected immediately if any peer is left with no digits, instead of when the search reaches that cell.
+// - Conflict-directed backjumping: each cell remembers which earlier placements removed its digits. When a cell runs
+//   out of digits, the search jumps straight back to the most recent placement involved in the conflict, instead of
+//   to the previous cell, which may have nothing to do with it.
+// The remaining digits of each cell are kept as bitmasks, built from occupancy bitmasks of the rows, columns and boxes.
+//
+// Driver code is the same as in "Backtracking Algorithm.cpp", except that a fresh copy of the puzzle is solved on each
+// of the 10 repeats.
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <ctime>
+#include <cstdint>
+using namespace std;
+
+// UNASSIGNED is used for empty
+// cells in sudoku grid
+#define UNASSIGNED 0
+
+// N is used for the size of Sudoku grid.
+// Size will be NxN
+#define N 9
+
+// Set of empty cells, identified by their position (0 to 80) in the
+// order in which they are filled in.
+struct CellSet
+{
+	uint64_t w[2] = {0, 0};
+
+	void add(int i) { w[i / 64] |= 1ULL << (i % 64); }
+	void remove(int i) { w[i / 64] &= ~(1ULL << (i % 64)); }
+	void merge(const CellSet& o) { w[0] |= o.w[0]; w[1] |= o.w[1]; }
+	void clear() { w[0] = w[1] = 0; }
+
+	// Returns the latest cell in the set, or -1 if it is empty.
+	int latest() const
+	{
+		if (w[1]) return 64 + 63 - __builtin_clzll(w[1]);
+		if (w[0]) return 63 - __builtin_clzll(w[0]);
+		return -1;
+	}
+};
+
+// State of the search over the empty cells of one puzzle.
+struct Search
+{
+	int n;                 // Number of empty cells.
+	int cell[81];          // Grid position (row*9 + col) of each empty cell, in the order they are filled in.
+	int value[81];         // Digit currently placed in each empty cell.
+	uint16_t initial[81];  // Digits allowed in each empty cell by the givens.
+	uint16_t domain[81];   // Digits still to be tried in each empty cell.
+	CellSet past_fc[81];   // Earlier cells whose placements removed digits from this cell (forward checking).
+	CellSet conf_set[81];  // Earlier cells involved in conflicts found while trying digits in this cell.
+	int reduced[81][20];   // Later cells that the placement in this cell removed a digit from.
+	int reduced_count[81];
+};
+
+// Whether two grid positions are different and share
+// a row, column or 3x3 box. Filled in by InitPeers.
+bool Peers[81][81];
+
+void InitPeers()
+{
+	for (int a = 0; a < 81; a++)
+		for (int b = 0; b < 81; b++)
+			Peers[a][b] = a != b && (a / N == b / N || a % N == b % N
+				|| (a / 27 == b / 27 && (a % N) / 3 == (b % N) / 3));
+}
+
+/* Sets up the search from the given grid. Returns false if the givens
+break the rules or leave an empty cell with no digit allowed. */
+bool Setup(int grid[N][N], Search& s)
+{
+	// Occupancy bitmasks: bit d-1 is set if digit d
+	// is already in the row, column or box.
+	uint16_t rows[N] = {0}, cols[N] = {0}, boxes[N] = {0};
+	for (int row = 0; row < N; row++)
+		for (int col = 0; col < N; col++)
+			if (grid[row][col] != UNASSIGNED)
+			{
+				const uint16_t bit = 1 << (grid[row][col] - 1);
+
+				// Two equal givens in a row, column or box.
+				if ((rows[row] | cols[col] | boxes[(row / 3) * 3 + col / 3]) & bit)
+					return false;
+				rows[row] |= bit;
+				cols[col] |= bit;
+				boxes[(row / 3) * 3 + col / 3] |= bit;
+			}
+
+	s.n = 0;
+	for (int row = 0; row < N; row++)
+		for (int col = 0; col < N; col++)
+			if (grid[row][col] == UNASSIGNED)
+			{
+				const int i = s.n++;
+				s.cell[i] = row * N + col;
+				s.initial[i] = 0x1FF & ~(rows[row] | cols[col] | boxes[(row / 3) * 3 + col / 3]);
+				s.domain[i] = s.initial[i];
+				s.past_fc[i].clear();
+				s.conf_set[i].clear();
+				s.reduced_count[i] = 0;
+				if (s.initial[i] == 0)
+					return false;
+			}
+	return true;
+}
+
+/* Gives back the digit placed in empty cell i to every
+later cell it was removed from by forward checking. */
+void UndoReductions(Search& s, int i)
+{
+	const uint16_t bit = 1 << (s.value[i] - 1);
+	for (int r = 0; r < s.reduced_count[i]; r++)
+	{
+		const int j = s.reduced[i][r];
+		s.domain[j] |= bit;
+		s.past_fc[j].remove(i);
+	}
+	s.reduced_count[i] = 0;
+}
+
+/* Tries the digits left in empty cell i in increasing order,
+forward checking each one. Returns i+1 if a digit was placed,
+or i if every digit led to a peer with no digits left. */
+int Label(Search& s, int i)
+{
+	while (s.domain[i])
+	{
+		const int num = __builtin_ctz(s.domain[i]) + 1;
+		const uint16_t bit = 1 << (num - 1);
+		s.value[i] = num;
+
+		// Remove num from every later peer, stopping at the
+		// first one that is left with no digits.
+		int wiped_out = -1;
+		for (int j = i + 1; j < s.n && wiped_out < 0; j++)
+			if (Peers[s.cell[i]][s.cell[j]] && (s.domain[j] & bit))
+			{
+				s.domain[j] &= ~bit;
+				s.past_fc[j].add(i);
+				s.reduced[i][s.reduced_count[i]++] = j;
+				if (s.domain[j] == 0)
+					wiped_out = j;
+			}
+
+		if (wiped_out < 0)
+			return i + 1;
+
+		// Failure: unmake, remember which earlier cells
+		// emptied the peer, and try the next digit.
+		UndoReductions(s, i);
+		s.domain[i] &= ~bit;
+		s.conf_set[i].merge(s.past_fc[wiped_out]);
+	}
+	return i;
+}
+
+/* Called when empty cell i has no digits left. Jumps back to the
+latest earlier cell involved in the conflict, resetting every cell
+in between, and removes that cell's digit so a different one is tried.
+Returns the cell jumped back to, or -1 if the puzzle has no solution. */
+int Unlabel(Search& s, int i)
+{
+	CellSet culprits = s.conf_set[i];
+	culprits.merge(s.past_fc[i]);
+	const int h = culprits.latest();
+	if (h < 0)
+		return -1;
+
+	culprits.remove(h);
+	s.conf_set[h].merge(culprits);
+
+	for (int j = i; j > h; j--)
+	{
+		s.conf_set[j].clear();
+		if (j < i)
+			UndoReductions(s, j);
+	}
+	UndoReductions(s, h);
+
+	// Every cell after h gets back the digits that were only
+	// removed by placements that have now been undone.
+	for (int j = h + 1; j <= i; j++)
+	{
+		s.domain[j] = s.initial[j];
+		for (int p = 0; p < h; p++)
+			if (s.past_fc[j].w[p / 64] >> (p % 64) & 1)
+				s.domain[j] &= ~(1 << (s.value[p] - 1));
+	}
+
+	s.domain[h] &= ~(1 << (s.value[h] - 1));
+	return h;
+}
+
+/* Takes a partially filled-in grid and attempts
+to assign values to all unassigned locations in
+such a way to meet the requirements for
+Sudoku solution (non-duplication across rows,
+columns, and boxes) */
+bool SolveSudoku(int grid[N][N])
+{
+	static Search s;
+	if (!Setup(grid, s))
+		return false;
+
+	int i = 0;
+	while (i < s.n)
+	{
+		// A cell whose digits have all been tried
+		// triggers a backjump.
+		if (s.domain[i] == 0)
+		{
+			i = Unlabel(s, i);
+			if (i < 0)
+				return false;
+			continue;
+		}
+		const int next = Label(s, i);
+		if (next == i && s.domain[i] == 0)
+		{
+			i = Unlabel(s, i);
+			if (i < 0)
+				return false;
+		}
+		else
+			i = next;
+	}
+
+	// success!
+	for (int j = 0; j < s.n; j++)
+		grid[s.cell[j] / N][s.cell[j] % N] = s.value[j];
+	return true;
+}
+
+/* A utility function to print grid */
+void printGrid(int grid[N][N])
+{
+	for (int row = 0; row < N; row++)
+	{
+		for (int col = 0; col < N; col++)
+			cout << grid[row][col] << " ";
+		cout << endl;
+	}
+}
+
+// ==================================== Driver Code ===============================================
+int main()
+{
+	InitPeers();
+
+	// Opening the text file containing the sudoku puzzles to be solved.
+	ifstream file_to_open("Diabolical Sudokus.txt");
+
+	string line;
+
+	while (getline(file_to_open, line))
+	{
+		// Initialize a counter to ensure that each sudoku puzzle is solved 10 times to ensure measurability and repeatability.
+		int loop = 0;
+
+		// Stores the time taken to solve the sudoku puzzles 10 times.
+		double one_sudoku_time = 0;
+
+		while (loop < 10)
+		{
+			// Convert the input from the file to an array to be solved.
+			// This is done on every repeat, since solving fills in the array.
+			int sudoku_grid[9][9];
+			for (int r = 0; r < 9; r++)
+				for (int c = 0; c < 9; c++)
+					sudoku_grid[r][c] = line[r * 9 + c] >= '1' && line[r * 9 + c] <= '9' ? line[r * 9 + c] - '0' : UNASSIGNED;
+
+			// Store the time at the START of the function.
+			clock_t start = clock();
+
+			// Calls the function to solve the sudoku puzzle.
+			SolveSudoku(sudoku_grid);
+
+			// Store the time at the END of the function.
+			clock_t end = clock();
+
+			// Adding the time taken to solve this sudoku puzzle once to the total time for the previous times this sudoku puzzle was solved.
+			one_sudoku_time += (end - start) / (double) CLOCKS_PER_SEC;
+
+			loop += 1;
+		}
+
+		// Outputs the average time taken to solve one sudoku puzzle to the terminal.
+		cout << fixed << one_sudoku_time / 10 << endl;
+	}
+
+	return 0;
+}
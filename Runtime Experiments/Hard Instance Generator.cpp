@@ -0,0 +1,646 @@
+// Generator of proper puzzles that are as hard as possible for one of the solvers in this folder: the backtracking
+// algorithm from "Backtracking Algorithm.cpp" (https://www.geeksforgeeks.org/sudoku-backtracking-7/) or the Norvig
+// solver from "Norvig Solver.cpp" (https://github.com/daochenw/sudoku). The Runtime Data files grade puzzles by human
+// difficulty, which says little about the worst cases of either engine; this searches for those directly.
+//
+// Each restart fills a random solution grid and removes its cells in random order while the puzzle stays proper,
+// giving a random minimal puzzle. It then hill-climbs over the clue sets of that grid, one random move at a time:
+// removing a clue, adding a clue, moving a clue to an empty cell, swapping two digits throughout the grid, or
+// swapping two rows of a band or two columns of a stack. The last two keep the puzzle proper but change the order
+// in which both engines visit cells and try digits. A move is kept if the puzzle still has a unique solution and
+// the target engine's score does not go down, so that the climb can drift across plateaus. The score is the number
+// of search nodes the engine visits, or its solve time (the fastest of three solves, in microseconds). Each solve
+// is abandoned after a node budget, so a score at the budget means "at least this hard".
+//
+// Restarts run in parallel, one per thread at a time, each from its own seed. The best puzzle of every restart is
+// written, hardest first, to "Adversarial Sudokus (<engine>).txt" in the format of the Runtime Data files, so the
+// original drivers can run it, and to "Adversarial Sudokus (<engine>).csv", which tags each puzzle with the engine,
+// metric, score, node count, budget and seed. Checking a tagged corpus re-solves every puzzle with its engine and
+// reports any puzzle whose node count has changed, to track regressions in the engines.
+//
+// Compile with: g++ -O2 -pthread -o hard "Hard Instance Generator.cpp"
+//
+// Usage:
+//   ./hard generate <engine> [nodes|time] [restarts] [iterations] [threads] [seed] [budget]
+//                                        hill-climbs from each restart (default 8 restarts of 500 moves, a node budget
+//                                        of 10 million) for backtracking or norvig.
+//   ./hard check <corpus.csv>            re-solves a tagged corpus and reports node counts that have changed. Exits
+//                                        with status 1 if any has.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
+#include <iomanip>
+using namespace std;
+
+// Number of search nodes visited while solving one puzzle, and the budget after which the solve is abandoned.
+struct SolveStats {
+   long nodes = 0;
+   long budget = 0;
+};
+
+// ================================= Backtracking Algorithm =======================================
+
+// UNASSIGNED is used for empty
+// cells in sudoku grid
+#define UNASSIGNED 0
+
+// N is used for the size of Sudoku grid.
+// Size will be NxN
+#define N 9
+
+bool FindUnassignedLocation(int grid[N][N], int& row, int& col);
+bool isSafe(int grid[N][N], int row, int col, int num);
+
+/* Takes a partially filled-in grid and attempts
+to assign values to all unassigned locations in
+such a way to meet the requirements for
+Sudoku solution (non-duplication across rows,
+columns, and boxes) */
+bool SolveSudoku(int grid[N][N], SolveStats& stats)
+{
+	int row, col;
+
+	// Give up once the budget has been used.
+	if (++stats.nodes >= stats.budget)
+		return false;
+
+	// If there is no unassigned location,
+	// we are done
+	if (!FindUnassignedLocation(grid, row, col))
+		// success!
+		return true;
+
+	// Consider digits 1 to 9
+	for (int num = 1; num <= 9; num++)
+	{
+		// Check if looks promising
+		if (isSafe(grid, row, col, num))
+		{
+			// Make tentative assignment
+			grid[row][col] = num;
+
+			// Return, if success
+			if (SolveSudoku(grid, stats))
+				return true;
+
+			// Failure, unmake & try again
+			grid[row][col] = UNASSIGNED;
+		}
+	}
+
+	// This triggers backtracking
+	return false;
+}
+
+/* Searches the grid to find an entry that is
+still unassigned. If found, the reference
+parameters row, col will be set the location
+that is unassigned, and true is returned.
+If no unassigned entries remain, false is returned. */
+bool FindUnassignedLocation(int grid[N][N], int& row, int& col)
+{
+	for (row = 0; row < N; row++)
+		for (col = 0; col < N; col++)
+			if (grid[row][col] == UNASSIGNED)
+				return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+an assigned entry in the specified row matches
+the given number. */
+bool UsedInRow(int grid[N][N], int row, int num)
+{
+	for (int col = 0; col < N; col++)
+		if (grid[row][col] == num)
+			return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+an assigned entry in the specified column
+matches the given number. */
+bool UsedInCol(int grid[N][N], int col, int num)
+{
+	for (int row = 0; row < N; row++)
+		if (grid[row][col] == num)
+			return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+an assigned entry within the specified 3x3 box
+matches the given number. */
+bool UsedInBox(int grid[N][N], int boxStartRow, int boxStartCol, int num)
+{
+	for (int row = 0; row < 3; row++)
+		for (int col = 0; col < 3; col++)
+			if (grid[row + boxStartRow][col + boxStartCol] == num)
+				return true;
+	return false;
+}
+
+/* Returns a boolean which indicates whether
+it will be legal to assign num to the given
+row, col location. */
+bool isSafe(int grid[N][N], int row, int col, int num)
+{
+	/* Check if 'num' is not already placed in
+	current row, current column
+	and current 3x3 box */
+	return !UsedInRow(grid, row, num)
+		&& !UsedInCol(grid, col, num)
+		&& !UsedInBox(grid, row - row % 3, col - col % 3, num)
+		&& grid[row][col] == UNASSIGNED;
+}
+
+#undef N
+
+// ===================================== Norvig Solver ============================================
+
+class Possible {
+   vector<bool> _b;
+public:
+   Possible() : _b(9, true) {}
+   bool   is_on(int i) const { return _b[i-1]; }
+   int    count()      const { return std::count(_b.begin(), _b.end(), true); }
+   void   eliminate(int i)   { _b[i-1] = false; }
+   int    val()        const {
+      auto it = find(_b.begin(), _b.end(), true);
+      return (it != _b.end() ? 1 + (it - _b.begin()) : -1);
+   }
+};
+
+class Sudoku {
+   vector<Possible> _cells;
+   static vector< vector<int> > _group, _neighbors, _groups_of;
+
+   bool     eliminate(int k, int val);
+public:
+   Sudoku(string s);
+   static void init();
+
+   Possible possible(int k) const { return _cells[k]; }
+   bool     is_solved() const;
+   bool     assign(int k, int val);
+   int      least_count() const;
+};
+
+bool Sudoku::is_solved() const {
+   for (int k = 0; k < _cells.size(); k++) {
+      if (_cells[k].count() != 1) {
+         return false;
+      }
+   }
+   return true;
+}
+
+vector< vector<int> >
+Sudoku::_group(27), Sudoku::_neighbors(81), Sudoku::_groups_of(81);
+
+void Sudoku::init() {
+   for (int i = 0; i < 9; i++) {
+      for (int j = 0; j < 9; j++) {
+         const int k = i*9 + j;
+         const int x[3] = {i, 9 + j, 18 + (i/3)*3 + j/3};
+         for (int g = 0; g < 3; g++) {
+            _group[x[g]].push_back(k);
+            _groups_of[k].push_back(x[g]);
+         }
+      }
+   }
+   for (int k = 0; k < _neighbors.size(); k++) {
+      for (int x = 0; x < _groups_of[k].size(); x++) {
+         for (int j = 0; j < 9; j++) {
+            int k2 = _group[_groups_of[k][x]][j];
+            if (k2 != k) _neighbors[k].push_back(k2);
+         }
+      }
+   }
+}
+
+bool Sudoku::assign(int k, int val) {
+   for (int i = 1; i <= 9; i++) {
+      if (i != val) {
+         if (!eliminate(k, i)) return false;
+      }
+   }
+   return true;
+}
+
+bool Sudoku::eliminate(int k, int val) {
+   if (!_cells[k].is_on(val)) {
+      return true;
+   }
+   _cells[k].eliminate(val);
+   const int N = _cells[k].count();
+   if (N == 0) {
+      return false;
+   } else if (N == 1) {
+      const int v = _cells[k].val();
+      for (int i = 0; i < _neighbors[k].size(); i++) {
+         if (!eliminate(_neighbors[k][i], v)) return false;
+      }
+   }
+   for (int i = 0; i < _groups_of[k].size(); i++) {
+      const int x = _groups_of[k][i];
+      int n = 0, ks;
+      for (int j = 0; j < 9; j++) {
+         const int p = _group[x][j];
+         if (_cells[p].is_on(val)) {
+            n++, ks = p;
+         }
+      }
+      if (n == 0) {
+         return false;
+      } else if (n == 1) {
+         if (!assign(ks, val)) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+int Sudoku::least_count() const {
+   int k = -1, min;
+   for (int i = 0; i < _cells.size(); i++) {
+      const int m = _cells[i].count();
+      if (m > 1 && (k == -1 || m < min)) {
+         min = m, k = i;
+      }
+   }
+   return k;
+}
+
+Sudoku::Sudoku(string s)
+  : _cells(81)
+{
+   int k = 0;
+   for (int i = 0; i < s.size(); i++) {
+      if (s[i] >= '1' && s[i] <= '9') {
+         if (!assign(k, s[i] - '0')) {
+            cerr << "error" << endl;
+            return;
+         }
+         k++;
+      } else if (s[i] == '0' || s[i] == '.') {
+         k++;
+      }
+   }
+}
+
+// The solver's search, unchanged except that it counts the nodes it visits and gives up once the budget is used.
+unique_ptr<Sudoku> solve(unique_ptr<Sudoku> S, SolveStats& stats) {
+   if (++stats.nodes >= stats.budget) {
+      return {};
+   }
+   if (S == nullptr || S->is_solved()) {
+      return S;
+   }
+   int k = S->least_count();
+   Possible p = S->possible(k);
+   for (int i = 1; i <= 9; i++) {
+      if (p.is_on(i)) {
+         unique_ptr<Sudoku> S1(new Sudoku(*S));
+         if (S1->assign(k, i)) {
+            if (auto S2 = solve(std::move(S1), stats)) {
+               return S2;
+            }
+         }
+      }
+   }
+   return {};
+}
+
+// ===================================== Engine Table =============================================
+
+// Solves a puzzle of 81 characters ('0' for empty cells) with the backtracking algorithm.
+void run_backtracking(const string& puzzle, SolveStats& stats) {
+   int grid[9][9];
+   for (int k = 0; k < 81; k++) {
+      grid[k/9][k%9] = puzzle[k] - '0';
+   }
+   SolveSudoku(grid, stats);
+}
+
+// Solves a puzzle of 81 characters ('0' for empty cells) with the Norvig solver.
+void run_norvig(const string& puzzle, SolveStats& stats) {
+   solve(unique_ptr<Sudoku>(new Sudoku(puzzle)), stats);
+}
+
+// Every engine puzzles can be generated for. Corpora refer to engines by name.
+struct Engine {
+   const char* name;
+   void (*run)(const string& puzzle, SolveStats& stats);
+};
+
+const Engine engines[] = {
+   {"backtracking", run_backtracking},
+   {"norvig", run_norvig},
+};
+
+const Engine* find_engine(const string& name) {
+   for (const Engine& e : engines) {
+      if (name == e.name) return &e;
+   }
+   return nullptr;
+}
+
+// Score of a puzzle for the engine: its node count, or the fastest of three solve times in microseconds. Node counts
+// are small integers for the Norvig solver, so ties between them are broken in favour of fewer givens, which keeps
+// the climb moving towards sparser puzzles while the node count is on a plateau.
+double score(const Engine& engine, bool by_time, const string& puzzle, long budget, long& nodes) {
+   double fastest = 0;
+   for (int repeat = 0; repeat < (by_time ? 3 : 1); repeat++) {
+      SolveStats stats;
+      stats.budget = budget;
+      auto start = chrono::steady_clock::now();
+      engine.run(puzzle, stats);
+      const double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+      fastest = repeat == 0 ? us : min(fastest, us);
+      nodes = stats.nodes;
+   }
+   return by_time ? fastest : nodes + count(puzzle.begin(), puzzle.end(), '0') / 100.0;
+}
+
+// ==================================== Grids and Uniqueness ======================================
+
+// Returns the number of solutions of a puzzle (81 digits, 0 for empty), counting no further than limit. The search
+// fills the empty cell with the fewest candidates first, keeping the candidates of each row, column and box as
+// bitmasks. Also used with a shuffled digit order to fill random solution grids.
+class SolutionCounter {
+   int _cells[81];
+   uint16_t _rows[9], _cols[9], _boxes[9];
+   int _count, _limit;
+   int _order[9];
+
+   static int box(int k) { return (k / 27) * 3 + (k % 9) / 3; }
+
+   void search() {
+      int best = -1, best_count = 10;
+      uint16_t best_mask = 0;
+      for (int k = 0; k < 81 && best_count > 1; k++) {
+         if (_cells[k]) continue;
+         const uint16_t mask = 0x1FF & ~(_rows[k / 9] | _cols[k % 9] | _boxes[box(k)]);
+         const int c = __builtin_popcount(mask);
+         if (c < best_count) best = k, best_count = c, best_mask = mask;
+      }
+      if (best < 0) {
+         _count++;
+         return;
+      }
+      for (int i = 0; i < 9 && _count < _limit; i++) {
+         const int d = _order[i];
+         const uint16_t bit = 1 << (d - 1);
+         if (!(best_mask & bit)) continue;
+         place(best, d, bit);
+         search();
+         if (_count >= _limit) return;
+         unplace(best, bit);
+      }
+   }
+
+   void place(int k, int d, uint16_t bit) {
+      _cells[k] = d;
+      _rows[k / 9] |= bit, _cols[k % 9] |= bit, _boxes[box(k)] |= bit;
+   }
+
+   void unplace(int k, uint16_t bit) {
+      _cells[k] = 0;
+      _rows[k / 9] &= ~bit, _cols[k % 9] &= ~bit, _boxes[box(k)] &= ~bit;
+   }
+
+public:
+   // Counts the solutions of the puzzle, trying digits in the given order. Returns 0 if the givens clash.
+   int count(const string& puzzle, int limit, const int order[9]) {
+      memset(_rows, 0, sizeof(_rows)), memset(_cols, 0, sizeof(_cols)), memset(_boxes, 0, sizeof(_boxes));
+      copy(order, order + 9, _order);
+      for (int k = 0; k < 81; k++) {
+         _cells[k] = puzzle[k] - '0';
+         if (!_cells[k]) continue;
+         const uint16_t bit = 1 << (_cells[k] - 1);
+         if ((_rows[k / 9] | _cols[k % 9] | _boxes[box(k)]) & bit) return 0;
+         place(k, _cells[k], bit);
+      }
+      _count = 0, _limit = limit;
+      search();
+      return _count;
+   }
+
+   // The grid of the last solution found by count().
+   string grid() const {
+      string g(81, '0');
+      for (int k = 0; k < 81; k++) g[k] = '0' + _cells[k];
+      return g;
+   }
+};
+
+bool is_proper(const string& puzzle) {
+   static const int order[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+   SolutionCounter counter;
+   return counter.count(puzzle, 2, order) == 1;
+}
+
+// Returns a random minimal puzzle: a random solution grid with cells removed in random order while it stays proper.
+string random_minimal_puzzle(mt19937& rng, string& solution) {
+   int order[9] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+   shuffle(order, order + 9, rng);
+   SolutionCounter counter;
+   counter.count(string(81, '0'), 1, order);
+   solution = counter.grid();
+
+   string puzzle = solution;
+   vector<int> cells(81);
+   for (int k = 0; k < 81; k++) cells[k] = k;
+   shuffle(cells.begin(), cells.end(), rng);
+   for (int k : cells) {
+      puzzle[k] = '0';
+      if (!is_proper(puzzle)) puzzle[k] = solution[k];
+   }
+   return puzzle;
+}
+
+// ====================================== Hill Climbing ===========================================
+
+// Best puzzle found by one restart.
+struct Climb {
+   string puzzle;
+   double score = 0;
+   long nodes = 0;
+   long accepted = 0;  // Number of moves kept.
+};
+
+// Climbs from a random minimal puzzle for the given number of moves.
+Climb climb(const Engine& engine, bool by_time, int iterations, long budget, unsigned seed, unsigned restart) {
+   seed_seq seq{seed, restart};
+   mt19937 rng(seq);
+   string solution;
+   Climb c;
+   c.puzzle = random_minimal_puzzle(rng, solution);
+   c.score = score(engine, by_time, c.puzzle, budget, c.nodes);
+
+   uniform_int_distribution<int> digit(1, 9), move(0, 4);
+   for (int it = 0; it < iterations; it++) {
+      string next = c.puzzle, next_solution = solution;
+      vector<int> given, empty;
+      for (int k = 0; k < 81; k++) (c.puzzle[k] != '0' ? given : empty).push_back(k);
+      auto pick = [&](const vector<int>& v) { return v[uniform_int_distribution<size_t>(0, v.size() - 1)(rng)]; };
+
+      const int m = move(rng);
+      if (m == 0 && given.size() > 17) {
+         // Removes a clue.
+         next[pick(given)] = '0';
+      } else if (m == 1 && !empty.empty()) {
+         // Adds a clue from the solution.
+         const int k = pick(empty);
+         next[k] = solution[k];
+      } else if (m == 2 && !empty.empty()) {
+         // Moves a clue to an empty cell.
+         const int from = pick(given), to = pick(empty);
+         next[from] = '0';
+         next[to] = solution[to];
+      } else if (m == 3) {
+         // Swaps two digits throughout the grid, which keeps the puzzle proper.
+         const char a = '0' + digit(rng), b = '0' + digit(rng);
+         for (int k = 0; k < 81; k++) {
+            for (string* s : {&next, &next_solution}) {
+               if ((*s)[k] == a) (*s)[k] = b;
+               else if ((*s)[k] == b) (*s)[k] = a;
+            }
+         }
+      } else if (m == 4) {
+         // Swaps two rows of a band, or two columns of a stack, which also keeps the puzzle proper.
+         const int band = uniform_int_distribution<int>(0, 2)(rng), a = band*3 + digit(rng) % 3, b = band*3 + digit(rng) % 3;
+         const bool rows = rng() & 1;
+         for (int i = 0; i < 9; i++) {
+            const int ka = rows ? a*9 + i : i*9 + a, kb = rows ? b*9 + i : i*9 + b;
+            swap(next[ka], next[kb]);
+            swap(next_solution[ka], next_solution[kb]);
+         }
+      } else {
+         continue;
+      }
+
+      // Adding a clue, relabelling digits or permuting lines cannot make the puzzle improper.
+      if ((m == 0 || m == 2) && !is_proper(next)) continue;
+
+      long nodes = 0;
+      const double s = score(engine, by_time, next, budget, nodes);
+      if (s >= c.score) {
+         c.puzzle = next, solution = next_solution, c.score = s, c.nodes = nodes;
+         c.accepted++;
+      }
+   }
+   return c;
+}
+
+// ======================================== Commands ==============================================
+
+int generate(const Engine& engine, bool by_time, int restarts, int iterations, int threads, unsigned seed, long budget) {
+   vector<Climb> climbs(restarts);
+   atomic<int> next(0);
+   auto start = chrono::steady_clock::now();
+
+   auto worker = [&]() {
+      for (int r = next++; r < restarts; r = next++) {
+         climbs[r] = climb(engine, by_time, iterations, budget, seed, r);
+         cerr << "Restart " << r << ": score " << fixed << setprecision(by_time ? 1 : 2) << climbs[r].score << ", " << climbs[r].nodes << " nodes, "
+              << climbs[r].accepted << " moves kept" << endl;
+      }
+   };
+   vector<thread> pool;
+   for (int t = 0; t < threads; t++) pool.emplace_back(worker);
+   for (thread& t : pool) t.join();
+
+   vector<int> order(restarts);
+   for (int r = 0; r < restarts; r++) order[r] = r;
+   stable_sort(order.begin(), order.end(), [&](int a, int b) { return climbs[a].score > climbs[b].score; });
+
+   const string name = string("Adversarial Sudokus (") + engine.name + ")";
+   ofstream puzzles(name + ".txt"), tagged(name + ".csv");
+   tagged << "puzzle,engine,metric,score,nodes,budget,givens,seed,restart" << endl;
+   for (int r : order) {
+      const Climb& c = climbs[r];
+      puzzles << c.puzzle << endl;
+      tagged << c.puzzle << "," << engine.name << "," << (by_time ? "time" : "nodes") << "," << fixed << setprecision(by_time ? 1 : 2) << c.score << ","
+             << c.nodes << "," << budget << "," << 81 - count(c.puzzle.begin(), c.puzzle.end(), '0') << ","
+             << seed << "," << r << endl;
+   }
+
+   cerr << "Hardest: " << climbs[order[0]].nodes << " nodes" << (climbs[order[0]].nodes >= budget ? " (budget reached)" : "")
+        << ", written to \"" << name << ".txt\" and \"" << name << ".csv\" in "
+        << chrono::duration<double>(chrono::steady_clock::now() - start).count() << " s" << endl;
+   return 0;
+}
+
+// Re-solves every puzzle of a tagged corpus with the engine it was generated for, with the same budget, and reports
+// the puzzles whose node count differs from the one recorded.
+int check(const string& file) {
+   ifstream in(file);
+   string line;
+   if (!getline(in, line)) {
+      cerr << "Could not read " << file << endl;
+      return 1;
+   }
+   long puzzles = 0, changed = 0;
+   while (getline(in, line)) {
+      stringstream fields(line);
+      string puzzle, engine_name, metric, score_field, nodes_field, budget_field;
+      getline(fields, puzzle, ','), getline(fields, engine_name, ','), getline(fields, metric, ',');
+      getline(fields, score_field, ','), getline(fields, nodes_field, ','), getline(fields, budget_field, ',');
+      const Engine* engine = find_engine(engine_name);
+      if (!engine || puzzle.size() != 81) {
+         cerr << "Skipping unreadable line: " << line << endl;
+         continue;
+      }
+      long nodes = 0;
+      score(*engine, false, puzzle, stol(budget_field), nodes);
+      puzzles++;
+      if (nodes != stol(nodes_field)) {
+         changed++;
+         cout << puzzle << "," << engine_name << ": " << nodes_field << " nodes recorded, " << nodes << " now" << endl;
+      }
+   }
+   cerr << puzzles << " puzzles checked, " << changed << " with a different node count" << endl;
+   return changed > 0;
+}
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   Sudoku::init();
+
+   if (argc >= 3 && strcmp(argv[1], "generate") == 0) {
+      const Engine* engine = find_engine(argv[2]);
+      if (!engine) {
+         cerr << "Unknown engine " << argv[2] << endl;
+         return 1;
+      }
+      const bool by_time = argc > 3 && strcmp(argv[3], "time") == 0;
+      const int restarts = argc > 4 ? stoi(argv[4]) : 8;
+      const int iterations = argc > 5 ? stoi(argv[5]) : 500;
+      const int threads = argc > 6 ? stoi(argv[6]) : max(1u, thread::hardware_concurrency());
+      const unsigned seed = argc > 7 ? stoul(argv[7]) : 1;
+      const long budget = argc > 8 ? stol(argv[8]) : 10000000;
+      return generate(*engine, by_time, restarts, iterations, threads, seed, budget);
+   }
+   if (argc >= 3 && strcmp(argv[1], "check") == 0) {
+      return check(argv[2]);
+   }
+
+   cerr << "Usage: " << argv[0] << " generate <engine> [nodes|time] [restarts] [iterations] [threads] [seed] [budget]"
+        << " | check <corpus.csv>" << endl;
+   return 1;
+}
@@ -0,0 +1,396 @@
+// Open-loop load generator for the Norvig solver (taken from "Norvig Solver.cpp", originally from the Github
+// repository https://github.com/daochenw/sudoku).
+//
+// The runtime experiment is closed-loop: a puzzle is only started once the previous one has finished, so a slow
+// solve delays every later measurement without ever being seen as a delay (coordinated omission). Here puzzles
+// instead arrive on a schedule fixed in advance, either as a Poisson process or in bursts, and are served first-come
+// first-served by a pool of worker threads. The latency of a puzzle is measured from the time it was scheduled to
+// arrive, not from when a worker picked it up, so time spent waiting behind a slow solve is counted.
+//
+// Latencies are recorded in HDR histograms (one per worker, merged at the end), and the load can be swept over a
+// range of arrival rates to produce a latency against throughput curve.
+//
+// Compile with: g++ -O2 -pthread -o loadgen "Load Generator.cpp"
+//
+// Usage:
+//   ./loadgen <file> [threads] [seconds per rate] [poisson|bursty] [rates...]
+// Rates are in puzzles per second. If none are given, the capacity of the pool is measured with a short closed-loop
+// run and rates from 10% to 120% of it are swept. Outputs one CSV line per rate.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+class Possible {
+   vector<bool> _b;
+public:
+   Possible() : _b(9, true) {}
+   bool   is_on(int i) const { return _b[i-1]; }
+   int    count()      const { return std::count(_b.begin(), _b.end(), true); }
+   void   eliminate(int i)   { _b[i-1] = false; }
+   int    val()        const {
+      auto it = find(_b.begin(), _b.end(), true);
+      return (it != _b.end() ? 1 + (it - _b.begin()) : -1);
+   }
+};
+
+class Sudoku {
+   vector<Possible> _cells;
+   static vector< vector<int> > _group, _neighbors, _groups_of;
+
+   bool     eliminate(int k, int val);
+public:
+   Sudoku(string s);
+   static void init();
+
+   Possible possible(int k) const { return _cells[k]; }
+   bool     is_solved() const;
+   bool     assign(int k, int val);
+   int      least_count() const;
+};
+
+bool Sudoku::is_solved() const {
+   for (int k = 0; k < _cells.size(); k++) {
+      if (_cells[k].count() != 1) {
+         return false;
+      }
+   }
+   return true;
+}
+
+vector< vector<int> >
+Sudoku::_group(27), Sudoku::_neighbors(81), Sudoku::_groups_of(81);
+
+void Sudoku::init() {
+   for (int i = 0; i < 9; i++) {
+      for (int j = 0; j < 9; j++) {
+         const int k = i*9 + j;
+         const int x[3] = {i, 9 + j, 18 + (i/3)*3 + j/3};
+         for (int g = 0; g < 3; g++) {
+            _group[x[g]].push_back(k);
+            _groups_of[k].push_back(x[g]);
+         }
+      }
+   }
+   for (int k = 0; k < _neighbors.size(); k++) {
+      for (int x = 0; x < _groups_of[k].size(); x++) {
+         for (int j = 0; j < 9; j++) {
+            int k2 = _group[_groups_of[k][x]][j];
+            if (k2 != k) _neighbors[k].push_back(k2);
+         }
+      }
+   }
+}
+
+bool Sudoku::assign(int k, int val) {
+   for (int i = 1; i <= 9; i++) {
+      if (i != val) {
+         if (!eliminate(k, i)) return false;
+      }
+   }
+   return true;
+}
+
+bool Sudoku::eliminate(int k, int val) {
+   if (!_cells[k].is_on(val)) {
+      return true;
+   }
+   _cells[k].eliminate(val);
+   const int N = _cells[k].count();
+   if (N == 0) {
+      return false;
+   } else if (N == 1) {
+      const int v = _cells[k].val();
+      for (int i = 0; i < _neighbors[k].size(); i++) {
+         if (!eliminate(_neighbors[k][i], v)) return false;
+      }
+   }
+   for (int i = 0; i < _groups_of[k].size(); i++) {
+      const int x = _groups_of[k][i];
+      int n = 0, ks;
+      for (int j = 0; j < 9; j++) {
+         const int p = _group[x][j];
+         if (_cells[p].is_on(val)) {
+            n++, ks = p;
+         }
+      }
+      if (n == 0) {
+         return false;
+      } else if (n == 1) {
+         if (!assign(ks, val)) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+int Sudoku::least_count() const {
+   int k = -1, min;
+   for (int i = 0; i < _cells.size(); i++) {
+      const int m = _cells[i].count();
+      if (m > 1 && (k == -1 || m < min)) {
+         min = m, k = i;
+      }
+   }
+   return k;
+}
+
+Sudoku::Sudoku(string s)
+  : _cells(81)
+{
+   int k = 0;
+   for (int i = 0; i < s.size(); i++) {
+      if (s[i] >= '1' && s[i] <= '9') {
+         if (!assign(k, s[i] - '0')) {
+            cerr << "error" << endl;
+            return;
+         }
+         k++;
+      } else if (s[i] == '0' || s[i] == '.') {
+         k++;
+      }
+   }
+}
+
+unique_ptr<Sudoku> solve(unique_ptr<Sudoku> S) {
+   if (S == nullptr || S->is_solved()) {
+      return S;
+   }
+   int k = S->least_count();
+   Possible p = S->possible(k);
+   for (int i = 1; i <= 9; i++) {
+      if (p.is_on(i)) {
+         unique_ptr<Sudoku> S1(new Sudoku(*S));
+         if (S1->assign(k, i)) {
+            if (auto S2 = solve(std::move(S1))) {
+               return S2;
+            }
+         }
+      }
+   }
+   return {};
+}
+
+// ===================================== HDR Histogram ============================================
+
+// High dynamic range histogram of integer values (here nanoseconds), following the bucket layout of HdrHistogram:
+// values are grouped into buckets covering powers of two, each split into enough linear sub-buckets to keep the
+// given number of significant decimal digits. Recording is a couple of shifts and an increment, so each worker
+// can record into its own histogram without locking, and histograms with the same layout are merged by adding counts.
+class HdrHistogram {
+   int64_t _lowest, _highest;
+   int _unit_magnitude, _sub_bucket_half_count_magnitude;
+   int64_t _sub_bucket_count, _sub_bucket_half_count, _sub_bucket_mask;
+   int _bucket_count;
+   vector<int64_t> _counts;
+   int64_t _total = 0, _min = INT64_MAX, _max = 0;
+
+   int bucket_index(int64_t v) const {
+      const int pow2ceiling = 64 - __builtin_clzll(v | _sub_bucket_mask);
+      return pow2ceiling - _unit_magnitude - (_sub_bucket_half_count_magnitude + 1);
+   }
+   int sub_bucket_index(int64_t v, int bucket) const { return (int)(v >> (bucket + _unit_magnitude)); }
+   size_t counts_index(int bucket, int sub) const {
+      return ((size_t)(bucket + 1) << _sub_bucket_half_count_magnitude) + (sub - _sub_bucket_half_count);
+   }
+   int64_t value_at(size_t index) const {
+      int bucket = (int)(index >> _sub_bucket_half_count_magnitude) - 1;
+      int64_t sub = (index & (_sub_bucket_half_count - 1)) + _sub_bucket_half_count;
+      if (bucket < 0) {
+         sub -= _sub_bucket_half_count;
+         bucket = 0;
+      }
+      return sub << (bucket + _unit_magnitude);
+   }
+   // Largest value that would be recorded in the same count as v.
+   int64_t highest_equivalent(int64_t v) const {
+      const int bucket = bucket_index(v);
+      const int sub = sub_bucket_index(v, bucket);
+      const int adjusted = sub >= _sub_bucket_count ? bucket + 1 : bucket;
+      const int64_t lowest = (int64_t)sub << (bucket + _unit_magnitude);
+      return lowest + ((int64_t)1 << (_unit_magnitude + adjusted)) - 1;
+   }
+
+public:
+   HdrHistogram(int64_t lowest, int64_t highest, int significant_figures) : _lowest(lowest), _highest(highest) {
+      const int64_t largest_single_unit = 2 * (int64_t)pow(10, significant_figures);
+      const int sub_bucket_count_magnitude = (int)ceil(log2((double)largest_single_unit));
+      _sub_bucket_half_count_magnitude = max(sub_bucket_count_magnitude, 1) - 1;
+      _unit_magnitude = (int)floor(log2((double)lowest));
+      _sub_bucket_count = (int64_t)1 << (_sub_bucket_half_count_magnitude + 1);
+      _sub_bucket_half_count = _sub_bucket_count / 2;
+      _sub_bucket_mask = (_sub_bucket_count - 1) << _unit_magnitude;
+
+      int64_t smallest_untrackable = _sub_bucket_count << _unit_magnitude;
+      _bucket_count = 1;
+      while (smallest_untrackable <= highest) {
+         if (smallest_untrackable > INT64_MAX / 2) {
+            _bucket_count++;
+            break;
+         }
+         smallest_untrackable <<= 1;
+         _bucket_count++;
+      }
+      _counts.assign((_bucket_count + 1) * _sub_bucket_half_count, 0);
+   }
+
+   // Records a value, clamping it to the trackable range.
+   void record(int64_t v) {
+      v = min(max(v, (int64_t)0), _highest);
+      const int bucket = bucket_index(v);
+      _counts[counts_index(bucket, sub_bucket_index(v, bucket))]++;
+      _total++;
+      _min = min(_min, v);
+      _max = max(_max, v);
+   }
+
+   // Adds the counts of another histogram with the same layout.
+   void merge(const HdrHistogram& o) {
+      for (size_t i = 0; i < _counts.size(); i++) _counts[i] += o._counts[i];
+      _total += o._total;
+      _min = min(_min, o._min);
+      _max = max(_max, o._max);
+   }
+
+   // Value below which the given percentage of the recorded values fall (to the precision of the histogram).
+   int64_t percentile(double p) const {
+      if (_total == 0) return 0;
+      const int64_t target = max((int64_t)1, (int64_t)(p / 100 * _total + 0.5));
+      int64_t seen = 0;
+      for (size_t i = 0; i < _counts.size(); i++) {
+         seen += _counts[i];
+         if (seen >= target) return min(highest_equivalent(value_at(i)), _max);
+      }
+      return _max;
+   }
+
+   int64_t total() const { return _total; }
+   int64_t max_value() const { return _max; }
+};
+
+// ====================================== Load Generation =========================================
+
+// Offsets (seconds from the start of the run) at which puzzles are scheduled to arrive.
+// Poisson: exponential gaps with mean 1/rate.
+// Bursty: bursts of 10 puzzles arriving together, with exponential gaps of mean 10/rate between bursts,
+// so the mean rate is the same but the load comes in spikes.
+vector<double> arrival_schedule(double rate, double seconds, bool bursty, unsigned seed) {
+   mt19937_64 rng(seed);
+   const int burst = bursty ? 10 : 1;
+   exponential_distribution<double> gap(rate / burst);
+   vector<double> arrivals;
+   for (double t = gap(rng); t < seconds; t += gap(rng)) {
+      for (int b = 0; b < burst; b++) arrivals.push_back(t);
+   }
+   return arrivals;
+}
+
+struct LoadResult {
+   double throughput;
+   HdrHistogram latency;
+};
+
+// Serves the schedule with the given number of workers. Workers take arrivals in order from a shared atomic
+// position, wait until the arrival is due if they are early, and record the time from the scheduled arrival
+// to the end of the solve. Taking arrivals in order makes this a first-come first-served queue.
+LoadResult run_load(const vector<string>& puzzles, const vector<double>& arrivals, int threads) {
+   vector<HdrHistogram> histograms(threads, HdrHistogram(1, 10000000000LL, 3));
+   atomic<size_t> next(0);
+   const auto start = chrono::steady_clock::now();
+
+   auto worker = [&](int t) {
+      size_t i;
+      while ((i = next.fetch_add(1)) < arrivals.size()) {
+         const auto due = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(arrivals[i]));
+         this_thread::sleep_until(due);
+         solve(unique_ptr<Sudoku>(new Sudoku(puzzles[i % puzzles.size()])));
+         histograms[t].record(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - due).count());
+      }
+   };
+
+   vector<thread> pool;
+   for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+   for (thread& t : pool) t.join();
+
+   const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+   LoadResult result{arrivals.size() / elapsed, histograms[0]};
+   for (int t = 1; t < threads; t++) result.latency.merge(histograms[t]);
+   return result;
+}
+
+// Throughput of the pool when every worker solves back to back (closed loop), used to choose the rates to sweep.
+double measure_capacity(const vector<string>& puzzles, int threads) {
+   const size_t n = min(puzzles.size(), (size_t)2000);
+   atomic<size_t> next(0);
+   const auto start = chrono::steady_clock::now();
+   vector<thread> pool;
+   for (int t = 0; t < threads; t++) {
+      pool.emplace_back([&]() {
+         size_t i;
+         while ((i = next.fetch_add(1)) < n) solve(unique_ptr<Sudoku>(new Sudoku(puzzles[i])));
+      });
+   }
+   for (thread& t : pool) t.join();
+   return n / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   Sudoku::init();
+
+   if (argc < 2) {
+      cerr << "Usage: " << argv[0] << " <file> [threads] [seconds per rate] [poisson|bursty] [rates...]" << endl;
+      return 1;
+   }
+
+   // Opening the text file containing the sudoku puzzles to be solved.
+   ifstream file_to_open(argv[1]);
+   vector<string> puzzles;
+   string line;
+   while (getline(file_to_open, line)) {
+      if (line.size() >= 81) puzzles.push_back(line.substr(0, 81));
+   }
+   if (puzzles.empty()) {
+      cerr << "Could not read any puzzles from " << argv[1] << endl;
+      return 1;
+   }
+
+   const int threads = argc > 2 ? stoi(argv[2]) : max(1u, thread::hardware_concurrency());
+   const double seconds = argc > 3 ? stod(argv[3]) : 5;
+   const bool bursty = argc > 4 && strcmp(argv[4], "bursty") == 0;
+
+   vector<double> rates;
+   for (int i = 5; i < argc; i++) rates.push_back(stod(argv[i]));
+   if (rates.empty()) {
+      const double capacity = measure_capacity(puzzles, threads);
+      cerr << "Closed-loop capacity: " << capacity << " puzzles per second" << endl;
+      for (double f : {0.1, 0.25, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, 1.1, 1.2}) rates.push_back(f * capacity);
+   }
+
+   // Outputs one line per arrival rate, with latencies in microseconds.
+   cout << "arrival process,offered rate,achieved throughput,p50,p90,p99,p99.9,max" << endl;
+   for (size_t r = 0; r < rates.size(); r++) {
+      const vector<double> arrivals = arrival_schedule(rates[r], seconds, bursty, r);
+      if (arrivals.empty()) continue;
+      const LoadResult result = run_load(puzzles, arrivals, threads);
+      const HdrHistogram& h = result.latency;
+      cout << (bursty ? "bursty" : "poisson") << "," << fixed << rates[r] << "," << result.throughput << ","
+           << h.percentile(50) / 1e3 << "," << h.percentile(90) / 1e3 << "," << h.percentile(99) / 1e3 << ","
+           << h.percentile(99.9) / 1e3 << "," << h.max_value() / 1e3 << endl;
+   }
+
+   return 0;
+}
@@ -0,0 +1,350 @@
+// Applies a chosen set of solving techniques to every puzzle in a file, without any guessing, and writes out the
+// candidates (pencil marks) left in each cell. Later stages (LP models, grading, analysis) can then start from the
+// propagated puzzle instead of repeating the propagation themselves.
+//
+// The candidates of a cell are held as a 9-bit mask (bit d-1 set if digit d is still possible), and a puzzle as 81
+// such masks. Pencil-mark files are simply these 81 masks stored as little-endian uint16 values, 162 bytes per puzzle,
+// with no header. The same format is accepted as input, so propagation can be continued from an earlier output.
+// A puzzle in which a contradiction was found is written with every mask 0, so that later stages cannot mistake it
+// for a valid one, and is found contradictory again if read back in.
+//
+// Techniques (the same ones counted in Data Set 3):
+//   singles          a cell with one candidate left has that digit removed from its peers.
+//   hidden-singles   a digit with one place left in a row, column or box is placed there.
+//   naked-pairs      two cells of a unit with the same two candidates have them removed from the rest of the unit.
+//   hidden-pairs     two digits confined to the same two cells of a unit have every other candidate removed from them.
+//   pointing         a digit confined to one row or column within a box is removed from the rest of that row or column.
+//   box-line         a digit confined to one box within a row or column is removed from the rest of that box.
+//
+// Puzzles are propagated in place, split evenly across the threads, and nothing is allocated per puzzle.
+//
+// Compile with: g++ -O2 -pthread -o propagate "Propagation Only.cpp"
+//
+// Usage:
+//   ./propagate <techniques> <input> <output> [threads]   e.g. ./propagate singles,hidden-singles "Hard Sudokus.txt" hard.pm
+//   ./propagate dump <pencil-mark file>                    prints the candidates of every cell, one puzzle per line.
+// The input is read as a pencil-mark file if its name ends in ".pm", and as a text file of puzzles otherwise.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <cstdint>
+#include <cstring>
+using namespace std;
+
+// Mask with all nine digits possible.
+const uint16_t ALL = 0x1FF;
+
+enum Technique : unsigned {
+   SINGLES        = 1 << 0,
+   HIDDEN_SINGLES = 1 << 1,
+   NAKED_PAIRS    = 1 << 2,
+   HIDDEN_PAIRS   = 1 << 3,
+   POINTING       = 1 << 4,
+   BOX_LINE       = 1 << 5,
+};
+
+// Cells of the 27 units (rows 0-8, columns 9-17, boxes 18-26) and the 20 peers of each cell.
+int units[27][9];
+int peers[81][20];
+
+void init_tables() {
+   for (int i = 0; i < 9; i++) {
+      for (int j = 0; j < 9; j++) {
+         units[i][j] = i*9 + j;
+         units[9 + j][i] = i*9 + j;
+         units[18 + (i/3)*3 + j/3][(i%3)*3 + j%3] = i*9 + j;
+      }
+   }
+   for (int k = 0; k < 81; k++) {
+      int n = 0;
+      for (int k2 = 0; k2 < 81; k2++) {
+         const bool same_row = k/9 == k2/9, same_col = k%9 == k2%9;
+         const bool same_box = (k/27 == k2/27) && ((k%9)/3 == (k2%9)/3);
+         if (k2 != k && (same_row || same_col || same_box)) peers[k][n++] = k2;
+      }
+   }
+}
+
+inline bool single(uint16_t m) { return m && !(m & (m - 1)); }
+
+// Removes the candidates in bits from cell k. Sets changed if anything was removed.
+// Returns false if the cell is left with no candidates.
+inline bool remove(uint16_t* cand, int k, uint16_t bits, bool& changed) {
+   if (!(cand[k] & bits)) return true;
+   cand[k] &= ~bits;
+   changed = true;
+   return cand[k] != 0;
+}
+
+bool naked_singles(uint16_t* cand, bool& changed) {
+   for (int k = 0; k < 81; k++) {
+      if (!single(cand[k])) continue;
+      for (int p : peers[k]) {
+         if (!remove(cand, p, cand[k], changed)) return false;
+      }
+   }
+   return true;
+}
+
+bool hidden_singles(uint16_t* cand, bool& changed) {
+   for (const auto& unit : units) {
+      uint16_t once = 0, twice = 0;
+      for (int k : unit) {
+         twice |= once & cand[k];
+         once |= cand[k];
+      }
+      if (once != ALL) return false;
+      for (uint16_t hidden = once & ~twice; hidden; hidden &= hidden - 1) {
+         const uint16_t bit = hidden & -hidden;
+         for (int k : unit) {
+            if ((cand[k] & bit) && cand[k] != bit) remove(cand, k, cand[k] & ~bit, changed);
+         }
+      }
+   }
+   return true;
+}
+
+bool naked_pairs(uint16_t* cand, bool& changed) {
+   for (const auto& unit : units) {
+      for (int a = 0; a < 9; a++) {
+         const uint16_t m = cand[unit[a]];
+         if (__builtin_popcount(m) != 2) continue;
+         for (int b = a + 1; b < 9; b++) {
+            if (cand[unit[b]] != m) continue;
+            for (int c = 0; c < 9; c++) {
+               if (c != a && c != b && !remove(cand, unit[c], m, changed)) return false;
+            }
+         }
+      }
+   }
+   return true;
+}
+
+// Positions (bit i for the i-th cell of the unit) at which each digit can still go.
+inline void positions(const uint16_t* cand, const int* unit, uint16_t* where) {
+   for (int d = 0; d < 9; d++) where[d] = 0;
+   for (int i = 0; i < 9; i++) {
+      for (uint16_t m = cand[unit[i]]; m; m &= m - 1) where[__builtin_ctz(m)] |= 1 << i;
+   }
+}
+
+bool hidden_pairs(uint16_t* cand, bool& changed) {
+   uint16_t where[9];
+   for (const auto& unit : units) {
+      positions(cand, unit, where);
+      for (int d1 = 0; d1 < 9; d1++) {
+         if (__builtin_popcount(where[d1]) != 2) continue;
+         for (int d2 = d1 + 1; d2 < 9; d2++) {
+            if (where[d2] != where[d1]) continue;
+            const uint16_t keep = (1 << d1) | (1 << d2);
+            for (uint16_t w = where[d1]; w; w &= w - 1) {
+               remove(cand, unit[__builtin_ctz(w)], ALL & ~keep, changed);
+            }
+         }
+      }
+   }
+   return true;
+}
+
+// Removes digit d from the cells of unit u that are not in box b.
+bool remove_outside_box(uint16_t* cand, int u, int b, int d, bool& changed) {
+   for (int k : units[u]) {
+      if (18 + (k/27)*3 + (k%9)/3 != b && !remove(cand, k, 1 << d, changed)) return false;
+   }
+   return true;
+}
+
+bool pointing(uint16_t* cand, bool& changed) {
+   uint16_t where[9];
+   for (int b = 18; b < 27; b++) {
+      positions(cand, units[b], where);
+      for (int d = 0; d < 9; d++) {
+         const uint16_t w = where[d];
+         if (!w || single(w)) continue;
+         const int first = units[b][__builtin_ctz(w)];
+         // Box positions 0-2, 3-5 and 6-8 are the box's three rows; positions i, i+3 and i+6 its three columns.
+         if (!(w & ~0x007) || !(w & ~0x038) || !(w & ~0x1C0)) {
+            if (!remove_outside_box(cand, first / 9, b, d, changed)) return false;
+         } else if (!(w & ~0x049) || !(w & ~0x092) || !(w & ~0x124)) {
+            if (!remove_outside_box(cand, 9 + first % 9, b, d, changed)) return false;
+         }
+      }
+   }
+   return true;
+}
+
+bool box_line(uint16_t* cand, bool& changed) {
+   uint16_t where[9];
+   for (int u = 0; u < 18; u++) {
+      positions(cand, units[u], where);
+      for (int d = 0; d < 9; d++) {
+         const uint16_t w = where[d];
+         if (!w || single(w)) continue;
+         // Line positions 0-2, 3-5 and 6-8 lie in three different boxes.
+         if (!(w & ~0x007) || !(w & ~0x038) || !(w & ~0x1C0)) {
+            const int first = units[u][__builtin_ctz(w)];
+            const int b = 18 + (first/27)*3 + (first%9)/3;
+            for (int k : units[b]) {
+               const bool on_line = u < 9 ? k / 9 == u : k % 9 == u - 9;
+               if (!on_line && !remove(cand, k, 1 << d, changed)) return false;
+            }
+         }
+      }
+   }
+   return true;
+}
+
+// Applies the chosen techniques to one puzzle until none of them removes a candidate.
+// Returns false if a contradiction is found, or if a cell has no candidate to begin with.
+bool propagate(uint16_t* cand, unsigned techniques) {
+   for (int k = 0; k < 81; k++) {
+      if (cand[k] == 0) return false;
+   }
+   bool changed = true;
+   while (changed) {
+      changed = false;
+      if ((techniques & SINGLES) && !naked_singles(cand, changed)) return false;
+      if (changed) continue;
+      if ((techniques & HIDDEN_SINGLES) && !hidden_singles(cand, changed)) return false;
+      if (changed) continue;
+      if ((techniques & NAKED_PAIRS) && !naked_pairs(cand, changed)) return false;
+      if ((techniques & HIDDEN_PAIRS) && !hidden_pairs(cand, changed)) return false;
+      if ((techniques & POINTING) && !pointing(cand, changed)) return false;
+      if ((techniques & BOX_LINE) && !box_line(cand, changed)) return false;
+   }
+   return true;
+}
+
+// Propagates count puzzles (81 masks each) in place, splitting them evenly across the threads.
+// Sets ok[i] to 0 for every puzzle in which a contradiction was found, and sets its masks to 0; otherwise ok[i] is 1.
+void propagate_batch(uint16_t* grids, uint8_t* ok, size_t count, unsigned techniques, int threads) {
+   vector<thread> pool;
+   for (int t = 0; t < threads; t++) {
+      const size_t begin = count * t / threads, end = count * (t + 1) / threads;
+      pool.emplace_back([=]() {
+         for (size_t i = begin; i < end; i++) {
+            ok[i] = propagate(grids + 81*i, techniques);
+            if (!ok[i]) fill(grids + 81*i, grids + 81*(i + 1), 0);
+         }
+      });
+   }
+   for (thread& t : pool) t.join();
+}
+
+// ===================================== Reading and Writing ======================================
+
+// Reads puzzles from a text file (81 characters per line, '0' or '.' for an empty cell, anything after the
+// 81st character ignored) as candidate masks, with every given reduced to a single candidate.
+vector<uint16_t> read_puzzles(const string& file) {
+   ifstream in(file);
+   vector<uint16_t> grids;
+   string line;
+   while (getline(in, line)) {
+      if (line.size() < 81) continue;
+      for (int k = 0; k < 81; k++) {
+         grids.push_back(line[k] >= '1' && line[k] <= '9' ? 1 << (line[k] - '1') : ALL);
+      }
+   }
+   return grids;
+}
+
+vector<uint16_t> read_pencil_marks(const string& file) {
+   ifstream in(file, ios::binary);
+   vector<uint16_t> grids;
+   uint8_t bytes[162];
+   while (in.read((char*)bytes, sizeof bytes)) {
+      for (int k = 0; k < 81; k++) grids.push_back(bytes[2*k] | bytes[2*k + 1] << 8);
+   }
+   return grids;
+}
+
+void write_pencil_marks(const string& file, const vector<uint16_t>& grids) {
+   ofstream out(file, ios::binary);
+   vector<uint8_t> bytes(grids.size() * 2);
+   for (size_t i = 0; i < grids.size(); i++) {
+      bytes[2*i] = grids[i] & 0xFF;
+      bytes[2*i + 1] = grids[i] >> 8;
+   }
+   out.write((const char*)bytes.data(), bytes.size());
+}
+
+unsigned parse_techniques(const string& list) {
+   unsigned techniques = 0;
+   stringstream ss(list);
+   string name;
+   while (getline(ss, name, ',')) {
+      if (name == "singles") techniques |= SINGLES;
+      else if (name == "hidden-singles") techniques |= HIDDEN_SINGLES;
+      else if (name == "naked-pairs") techniques |= NAKED_PAIRS;
+      else if (name == "hidden-pairs") techniques |= HIDDEN_PAIRS;
+      else if (name == "pointing") techniques |= POINTING;
+      else if (name == "box-line") techniques |= BOX_LINE;
+      else cerr << "Unknown technique " << name << endl;
+   }
+   return techniques;
+}
+
+bool ends_with(const string& s, const string& suffix) {
+   return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   init_tables();
+
+   if (argc == 3 && strcmp(argv[1], "dump") == 0) {
+      const vector<uint16_t> grids = read_pencil_marks(argv[2]);
+      for (size_t i = 0; i < grids.size(); i += 81) {
+         for (int k = 0; k < 81; k++) {
+            if (k) cout << " ";
+            for (int d = 0; d < 9; d++) {
+               if (grids[i + k] >> d & 1) cout << d + 1;
+            }
+         }
+         cout << endl;
+      }
+      return 0;
+   }
+
+   if (argc < 4) {
+      cerr << "Usage: " << argv[0] << " <techniques> <input> <output> [threads] | dump <pencil-mark file>" << endl;
+      return 1;
+   }
+
+   const unsigned techniques = parse_techniques(argv[1]);
+   const int threads = argc > 4 ? stoi(argv[4]) : max(1u, thread::hardware_concurrency());
+
+   vector<uint16_t> grids = ends_with(argv[2], ".pm") ? read_pencil_marks(argv[2]) : read_puzzles(argv[2]);
+   const size_t count = grids.size() / 81;
+   vector<uint8_t> ok(count);
+
+   auto start = chrono::steady_clock::now();
+   propagate_batch(grids.data(), ok.data(), count, techniques, threads);
+   const double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+   write_pencil_marks(argv[3], grids);
+
+   // Summary: how many puzzles were solved or found contradictory, and how many candidates remain on average.
+   size_t solved = 0, contradictions = 0, remaining = 0;
+   for (size_t i = 0; i < count; i++) {
+      if (!ok[i]) {
+         contradictions++;
+         continue;
+      }
+      int left = 0;
+      for (int k = 0; k < 81; k++) left += __builtin_popcount(grids[81*i + k]);
+      remaining += left;
+      if (left == 81) solved++;
+   }
+   cerr << "Puzzles: " << count << ", solved: " << solved << ", contradictions: " << contradictions
+        << ", mean candidates left: " << (count > contradictions ? (double)remaining / (count - contradictions) : 0)
+        << ", time: " << seconds << " s (" << count / seconds << " puzzles per second)" << endl;
+   return 0;
+}
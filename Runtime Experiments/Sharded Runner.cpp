@@ -0,0 +1,613 @@
+// Sharded runner: a coordinator that splits a data file into leases of consecutive puzzles and hands them over TCP
+// to worker processes, which solve them with the Norvig solver (taken from "Norvig Solver.cpp", originally from the
+// Github repository https://github.com/daochenw/sudoku) and send back the time and number of search nodes of each
+// solve. Workers can run on other machines; "local" mode runs everything on one machine over loopback, with forked
+// worker processes standing in for the nodes.
+//
+// Every message is one frame: a 4-byte little-endian payload length, a 1-byte message type, then the payload.
+//   HELLO  (worker -> coordinator)   worker id (4 bytes). A worker whose id is already held by another connected
+//                                    worker is dropped.
+//   LEASE  (coordinator -> worker)   lease id (4), index of the first puzzle (4), puzzle count n (4), then n puzzles
+//                                    of 81 bytes each ('1'-'9', or '.' for an empty cell).
+//   RESULT (worker -> coordinator)   lease id (4), puzzle count n (4), then per puzzle: search nodes (8),
+//                                    solve time in nanoseconds (8), and 1 if the puzzle was solved (1).
+//   DONE   (coordinator -> worker)   empty; there is no more work and the worker exits.
+// A worker holds one lease at a time and is given the next one when it returns a result. A worker whose connection
+// closes, or that does not return its lease within the lease timeout, is treated as dead: its connection is closed
+// and its lease is put back in the queue for the next idle worker.
+//
+// Compile with: g++ -O2 -o sharded "Sharded Runner.cpp"
+//
+// Usage:
+//   ./sharded coordinator <file> <port> [lease size] [lease timeout]   serves the puzzles in the file to workers.
+//   ./sharded worker <host> <port> [worker id]                         solves leases until the coordinator is done.
+//   ./sharded local <file> [workers] [lease size] [die after]           runs a coordinator and forked workers over
+//                                                                       loopback. If die after is given, worker 0
+//                                                                       exits without replying to that lease, to
+//                                                                       check that its work is re-leased.
+// The coordinator outputs the time taken to solve each sudoku puzzle in the order of the file, and the merged
+// counters per worker and in total. Lease sizes are in puzzles (default 50) and timeouts in seconds (default 60).
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <netdb.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+using namespace std;
+
+class Possible {
+   vector<bool> _b;
+public:
+   Possible() : _b(9, true) {}
+   bool   is_on(int i) const { return _b[i-1]; }
+   int    count()      const { return std::count(_b.begin(), _b.end(), true); }
+   void   eliminate(int i)   { _b[i-1] = false; }
+   int    val()        const {
+      auto it = find(_b.begin(), _b.end(), true);
+      return (it != _b.end() ? 1 + (it - _b.begin()) : -1);
+   }
+};
+
+class Sudoku {
+   vector<Possible> _cells;
+   static vector< vector<int> > _group, _neighbors, _groups_of;
+
+   bool     eliminate(int k, int val);
+public:
+   Sudoku(string s);
+   static void init();
+
+   Possible possible(int k) const { return _cells[k]; }
+   bool     is_solved() const;
+   bool     assign(int k, int val);
+   int      least_count() const;
+};
+
+bool Sudoku::is_solved() const {
+   for (int k = 0; k < _cells.size(); k++) {
+      if (_cells[k].count() != 1) {
+         return false;
+      }
+   }
+   return true;
+}
+
+vector< vector<int> >
+Sudoku::_group(27), Sudoku::_neighbors(81), Sudoku::_groups_of(81);
+
+void Sudoku::init() {
+   for (int i = 0; i < 9; i++) {
+      for (int j = 0; j < 9; j++) {
+         const int k = i*9 + j;
+         const int x[3] = {i, 9 + j, 18 + (i/3)*3 + j/3};
+         for (int g = 0; g < 3; g++) {
+            _group[x[g]].push_back(k);
+            _groups_of[k].push_back(x[g]);
+         }
+      }
+   }
+   for (int k = 0; k < _neighbors.size(); k++) {
+      for (int x = 0; x < _groups_of[k].size(); x++) {
+         for (int j = 0; j < 9; j++) {
+            int k2 = _group[_groups_of[k][x]][j];
+            if (k2 != k) _neighbors[k].push_back(k2);
+         }
+      }
+   }
+}
+
+bool Sudoku::assign(int k, int val) {
+   for (int i = 1; i <= 9; i++) {
+      if (i != val) {
+         if (!eliminate(k, i)) return false;
+      }
+   }
+   return true;
+}
+
+bool Sudoku::eliminate(int k, int val) {
+   if (!_cells[k].is_on(val)) {
+      return true;
+   }
+   _cells[k].eliminate(val);
+   const int N = _cells[k].count();
+   if (N == 0) {
+      return false;
+   } else if (N == 1) {
+      const int v = _cells[k].val();
+      for (int i = 0; i < _neighbors[k].size(); i++) {
+         if (!eliminate(_neighbors[k][i], v)) return false;
+      }
+   }
+   for (int i = 0; i < _groups_of[k].size(); i++) {
+      const int x = _groups_of[k][i];
+      int n = 0, ks;
+      for (int j = 0; j < 9; j++) {
+         const int p = _group[x][j];
+         if (_cells[p].is_on(val)) {
+            n++, ks = p;
+         }
+      }
+      if (n == 0) {
+         return false;
+      } else if (n == 1) {
+         if (!assign(ks, val)) {
+            return false;
+         }
+      }
+   }
+   return true;
+}
+
+int Sudoku::least_count() const {
+   int k = -1, min;
+   for (int i = 0; i < _cells.size(); i++) {
+      const int m = _cells[i].count();
+      if (m > 1 && (k == -1 || m < min)) {
+         min = m, k = i;
+      }
+   }
+   return k;
+}
+
+Sudoku::Sudoku(string s)
+  : _cells(81)
+{
+   int k = 0;
+   for (int i = 0; i < s.size(); i++) {
+      if (s[i] >= '1' && s[i] <= '9') {
+         if (!assign(k, s[i] - '0')) {
+            cerr << "error" << endl;
+            return;
+         }
+         k++;
+      } else if (s[i] == '0' || s[i] == '.') {
+         k++;
+      }
+   }
+}
+
+// The solver's search, unchanged except that it counts the nodes it visits.
+unique_ptr<Sudoku> solve(unique_ptr<Sudoku> S, long& nodes) {
+   nodes++;
+   if (S == nullptr || S->is_solved()) {
+      return S;
+   }
+   int k = S->least_count();
+   Possible p = S->possible(k);
+   for (int i = 1; i <= 9; i++) {
+      if (p.is_on(i)) {
+         unique_ptr<Sudoku> S1(new Sudoku(*S));
+         if (S1->assign(k, i)) {
+            if (auto S2 = solve(std::move(S1), nodes)) {
+               return S2;
+            }
+         }
+      }
+   }
+   return {};
+}
+
+// ======================================= Framing ================================================
+
+enum MessageType : uint8_t { HELLO = 1, LEASE = 2, RESULT = 3, DONE = 4 };
+
+// Frames larger than this are rejected as corrupt (a lease of 10000 puzzles is about 810 KB).
+const uint32_t MAX_FRAME = 1 << 24;
+
+void put32(string& out, uint32_t v) {
+   for (int i = 0; i < 4; i++) out += (char)(v >> (8*i));
+}
+
+void put64(string& out, uint64_t v) {
+   for (int i = 0; i < 8; i++) out += (char)(v >> (8*i));
+}
+
+uint32_t get32(const char* p) {
+   uint32_t v = 0;
+   for (int i = 0; i < 4; i++) v |= (uint32_t)(uint8_t)p[i] << (8*i);
+   return v;
+}
+
+uint64_t get64(const char* p) {
+   uint64_t v = 0;
+   for (int i = 0; i < 8; i++) v |= (uint64_t)(uint8_t)p[i] << (8*i);
+   return v;
+}
+
+// Writes a whole frame. Returns false if the connection has failed.
+bool send_frame(int fd, MessageType type, const string& payload) {
+   string frame;
+   put32(frame, payload.size());
+   frame += (char)type;
+   frame += payload;
+   size_t sent = 0;
+   while (sent < frame.size()) {
+      const ssize_t n = send(fd, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      sent += n;
+   }
+   return true;
+}
+
+// Removes the first complete frame from the front of a receive buffer. Returns 1 if a frame was
+// extracted, 0 if more bytes are needed, and -1 if the buffer holds a frame that is too large.
+int take_frame(string& buffer, MessageType& type, string& payload) {
+   if (buffer.size() < 5) return 0;
+   const uint32_t length = get32(buffer.data());
+   if (length > MAX_FRAME) return -1;
+   if (buffer.size() < 5 + length) return 0;
+   type = (MessageType)buffer[4];
+   payload = buffer.substr(5, length);
+   buffer.erase(0, 5 + length);
+   return 1;
+}
+
+// Blocks until a whole frame has been read. Returns false if the connection has closed or failed.
+bool recv_frame(int fd, string& buffer, MessageType& type, string& payload) {
+   for (;;) {
+      const int r = take_frame(buffer, type, payload);
+      if (r != 0) return r > 0;
+      char chunk[65536];
+      const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) return false;
+      buffer.append(chunk, n);
+   }
+}
+
+// ======================================== Worker ================================================
+
+// Connects to the coordinator and solves leases until it sends DONE or the connection closes. If die_after is
+// positive, the worker exits without replying once it has received that many leases, as a crashed node would.
+int run_worker(const string& host, const string& port, uint32_t id, int die_after) {
+   addrinfo hints = {}, *addresses;
+   hints.ai_family = AF_UNSPEC;
+   hints.ai_socktype = SOCK_STREAM;
+   if (getaddrinfo(host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+      cerr << "Could not resolve " << host << endl;
+      return 1;
+   }
+   int fd = -1;
+   for (addrinfo* a = addresses; a && fd < 0; a = a->ai_next) {
+      fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (fd >= 0 && connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+         close(fd);
+         fd = -1;
+      }
+   }
+   freeaddrinfo(addresses);
+   if (fd < 0) {
+      cerr << "Worker " << id << " could not connect to " << host << ":" << port << endl;
+      return 1;
+   }
+   const int one = 1;
+   setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+   string hello, buffer, payload;
+   put32(hello, id);
+   if (!send_frame(fd, HELLO, hello)) return 1;
+
+   MessageType type;
+   int leases = 0;
+   while (recv_frame(fd, buffer, type, payload) && type == LEASE && payload.size() >= 12) {
+      if (die_after > 0 && ++leases == die_after) _exit(1);
+
+      const uint32_t lease = get32(&payload[0]), count = get32(&payload[8]);
+      if (payload.size() != 12 + 81 * (size_t)count) break;
+
+      string result;
+      put32(result, lease);
+      put32(result, count);
+      for (uint32_t i = 0; i < count; i++) {
+         long nodes = 0;
+         auto start = chrono::steady_clock::now();
+         auto S = solve(unique_ptr<Sudoku>(new Sudoku(payload.substr(12 + 81 * i, 81))), nodes);
+         const auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+         put64(result, nodes);
+         put64(result, elapsed.count());
+         result += (char)(S != nullptr && S->is_solved());
+      }
+      if (!send_frame(fd, RESULT, result)) break;
+   }
+   close(fd);
+   return 0;
+}
+
+// ====================================== Coordinator =============================================
+
+// A range of consecutive puzzles handed out as one unit of work.
+struct Lease {
+   uint32_t first, count;
+   int attempts = 0;     // Number of times the lease has been handed out.
+   bool done = false;
+};
+
+// A connected worker, with the frames it has sent that have not yet been read in full.
+struct Connection {
+   int fd;
+   string buffer;
+   uint32_t id = 0;
+   bool greeted = false;
+   int lease = -1;                         // Lease currently held, or -1 if idle.
+   chrono::steady_clock::time_point deadline;
+};
+
+// Counters merged from the results sent by one worker.
+struct WorkerCounters {
+   long leases = 0, puzzles = 0, solved = 0, nodes = 0;
+   double seconds = 0;
+};
+
+// Reads the puzzles in a data file, keeping the 81 cells of each line with empty cells as '.'.
+vector<string> read_puzzles(const string& file) {
+   ifstream in(file);
+   vector<string> puzzles;
+   string line;
+   while (getline(in, line)) {
+      string p;
+      for (char c : line) {
+         if (c >= '1' && c <= '9') p += c;
+         else if (c == '0' || c == '.') p += '.';
+         if (p.size() == 81) break;
+      }
+      if (p.size() == 81) puzzles.push_back(p);
+   }
+   return puzzles;
+}
+
+// Hands out the leases of the puzzles to the workers that connect to the listening socket, until every lease has
+// a result. Outputs the solve times in the order of the file and the merged counters.
+int run_coordinator(int listener, const vector<string>& puzzles, uint32_t lease_size, double timeout) {
+   vector<Lease> leases;
+   for (uint32_t first = 0; first < puzzles.size(); first += lease_size) {
+      Lease l;
+      l.first = first;
+      l.count = min<uint32_t>(lease_size, puzzles.size() - first);
+      leases.push_back(l);
+   }
+   deque<int> pending;
+   for (size_t i = 0; i < leases.size(); i++) pending.push_back(i);
+   size_t leases_done = 0;
+   long releases = 0;
+
+   vector<double> times(puzzles.size());
+   map<uint32_t, WorkerCounters> counters;
+   vector<Connection> connections;
+   auto batch_start = chrono::steady_clock::now();
+
+   // Closes a connection, putting its lease back at the front of the queue.
+   auto drop = [&](size_t c, const char* reason) {
+      if (connections[c].lease >= 0) {
+         pending.push_front(connections[c].lease);
+         releases++;
+      }
+      cerr << "Worker " << connections[c].id << " " << reason;
+      if (connections[c].lease >= 0) cerr << ", re-leasing lease " << connections[c].lease;
+      cerr << endl;
+      close(connections[c].fd);
+      connections.erase(connections.begin() + c);
+   };
+
+   // Gives an idle worker the next pending lease. Returns false if the connection has failed.
+   auto hand_out = [&](Connection& w) {
+      if (pending.empty()) return true;
+      const int l = pending.front();
+      pending.pop_front();
+      string payload;
+      put32(payload, l);
+      put32(payload, leases[l].first);
+      put32(payload, leases[l].count);
+      for (uint32_t i = 0; i < leases[l].count; i++) payload += puzzles[leases[l].first + i];
+      w.lease = l;
+      w.deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+                      chrono::duration<double>(timeout));
+      leases[l].attempts++;
+      return send_frame(w.fd, LEASE, payload);
+   };
+
+   // Merges a result into the times and counters. Returns false if it does not match the lease held.
+   auto merge_result = [&](Connection& w, const string& payload) {
+      if (payload.size() < 8 || w.lease < 0 || get32(&payload[0]) != (uint32_t)w.lease) return false;
+      Lease& l = leases[w.lease];
+      if (get32(&payload[4]) != l.count || payload.size() != 8 + 17 * (size_t)l.count) return false;
+      WorkerCounters& wc = counters[w.id];
+      wc.leases++;
+      for (uint32_t i = 0; i < l.count; i++) {
+         const char* p = &payload[8 + 17 * i];
+         times[l.first + i] = get64(p + 8) / 1e9;
+         wc.puzzles++;
+         wc.nodes += get64(p);
+         wc.seconds += get64(p + 8) / 1e9;
+         wc.solved += p[16] != 0;
+      }
+      l.done = true;
+      leases_done++;
+      w.lease = -1;
+      return true;
+   };
+
+   while (leases_done < leases.size()) {
+      vector<pollfd> fds(1 + connections.size());
+      fds[0] = {listener, POLLIN, 0};
+      for (size_t c = 0; c < connections.size(); c++) fds[1 + c] = {connections[c].fd, POLLIN, 0};
+      if (poll(fds.data(), fds.size(), 100) < 0 && errno != EINTR) {
+         cerr << "poll failed: " << strerror(errno) << endl;
+         return 1;
+      }
+
+      // Reads from the existing connections first, backwards so that dropping one keeps the indices valid.
+      for (size_t c = connections.size(); c-- > 0;) {
+         if (!(fds[1 + c].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+         char chunk[65536];
+         const ssize_t n = recv(connections[c].fd, chunk, sizeof(chunk), 0);
+         if (n <= 0) {
+            drop(c, "disconnected");
+            continue;
+         }
+         Connection& w = connections[c];
+         w.buffer.append(chunk, n);
+
+         MessageType type;
+         string payload;
+         int r;
+         bool ok = true, duplicate = false;
+         while (ok && (r = take_frame(w.buffer, type, payload)) != 0) {
+            if (r < 0) ok = false;
+            else if (type == HELLO && !w.greeted && payload.size() == 4) {
+               w.id = get32(&payload[0]);
+               // Two workers with the same id would have their counters merged, so the second is refused.
+               for (const Connection& other : connections) {
+                  if (&other != &w && other.greeted && other.id == w.id) duplicate = true;
+               }
+               w.greeted = !duplicate;
+               ok = !duplicate && hand_out(w);
+            } else if (type == RESULT && w.greeted) {
+               ok = merge_result(w, payload) && hand_out(w);
+            } else ok = false;
+         }
+         if (duplicate) drop(c, "has the id of a connected worker");
+         else if (!ok) drop(c, "sent an invalid frame or could not be reached");
+      }
+
+      // Workers that have held a lease for too long are presumed dead.
+      const auto now = chrono::steady_clock::now();
+      for (size_t c = connections.size(); c-- > 0;) {
+         if (connections[c].lease >= 0 && now > connections[c].deadline) drop(c, "timed out");
+      }
+
+      // Re-leased work goes to workers that are waiting for a lease.
+      for (size_t c = connections.size(); c-- > 0;) {
+         if (connections[c].greeted && connections[c].lease < 0 && !hand_out(connections[c])) {
+            drop(c, "could not be reached");
+         }
+      }
+
+      if (fds[0].revents & POLLIN) {
+         const int fd = accept(listener, nullptr, nullptr);
+         if (fd >= 0) {
+            const int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            Connection w;
+            w.fd = fd;
+            connections.push_back(w);
+         }
+      }
+   }
+
+   for (Connection& w : connections) {
+      send_frame(w.fd, DONE, "");
+      close(w.fd);
+   }
+   const double makespan = chrono::duration<double>(chrono::steady_clock::now() - batch_start).count();
+
+   // Outputs the time taken to solve each sudoku puzzle, in the order of the file.
+   for (double t : times) cout << fixed << t << endl;
+
+   WorkerCounters total;
+   cerr << "worker,leases,puzzles,solved,nodes,solve seconds" << endl;
+   for (const auto& entry : counters) {
+      const WorkerCounters& wc = entry.second;
+      cerr << entry.first << "," << wc.leases << "," << wc.puzzles << "," << wc.solved << "," << wc.nodes << ","
+           << wc.seconds << endl;
+      total.leases += wc.leases, total.puzzles += wc.puzzles, total.solved += wc.solved;
+      total.nodes += wc.nodes, total.seconds += wc.seconds;
+   }
+   cerr << "total," << total.leases << "," << total.puzzles << "," << total.solved << "," << total.nodes << ","
+        << total.seconds << endl;
+   cerr << "Leases: " << leases.size() << ", re-leased: " << releases << ", makespan: " << makespan << " s" << endl;
+   return 0;
+}
+
+// Opens a TCP socket listening on the given port of the given address (port 0 picks a free port).
+int listen_on(in_addr_t address, uint16_t port) {
+   const int fd = socket(AF_INET, SOCK_STREAM, 0);
+   const int one = 1;
+   setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+   sockaddr_in a = {};
+   a.sin_family = AF_INET;
+   a.sin_addr.s_addr = address;
+   a.sin_port = htons(port);
+   if (fd < 0 || bind(fd, (sockaddr*)&a, sizeof(a)) != 0 || listen(fd, 64) != 0) {
+      cerr << "Could not listen on port " << port << ": " << strerror(errno) << endl;
+      return -1;
+   }
+   return fd;
+}
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   Sudoku::init();
+
+   if (argc >= 4 && strcmp(argv[1], "worker") == 0) {
+      return run_worker(argv[2], argv[3], argc > 4 ? stoul(argv[4]) : getpid(), 0);
+   }
+
+   if (argc >= 4 && strcmp(argv[1], "coordinator") == 0) {
+      const vector<string> puzzles = read_puzzles(argv[2]);
+      if (puzzles.empty()) {
+         cerr << "Could not read any puzzles from " << argv[2] << endl;
+         return 1;
+      }
+      const int listener = listen_on(INADDR_ANY, stoi(argv[3]));
+      if (listener < 0) return 1;
+      return run_coordinator(listener, puzzles, argc > 4 ? stoul(argv[4]) : 50, argc > 5 ? stod(argv[5]) : 60);
+   }
+
+   if (argc >= 3 && strcmp(argv[1], "local") == 0) {
+      const vector<string> puzzles = read_puzzles(argv[2]);
+      if (puzzles.empty()) {
+         cerr << "Could not read any puzzles from " << argv[2] << endl;
+         return 1;
+      }
+      const int workers = argc > 3 ? stoi(argv[3]) : 4;
+      const uint32_t lease_size = argc > 4 ? stoul(argv[4]) : 50;
+      const int die_after = argc > 5 ? stoi(argv[5]) : 0;
+
+      const int listener = listen_on(htonl(INADDR_LOOPBACK), 0);
+      if (listener < 0) return 1;
+      sockaddr_in a = {};
+      socklen_t length = sizeof(a);
+      getsockname(listener, (sockaddr*)&a, &length);
+      const string port = to_string(ntohs(a.sin_port));
+
+      // The output buffered so far must not be flushed again by the children.
+      cout.flush();
+      vector<pid_t> children;
+      for (int w = 0; w < workers; w++) {
+         const pid_t pid = fork();
+         if (pid == 0) {
+            close(listener);
+            _exit(run_worker("127.0.0.1", port, w, w == 0 ? die_after : 0));
+         }
+         children.push_back(pid);
+      }
+
+      const int status = run_coordinator(listener, puzzles, lease_size, 60);
+      close(listener);
+      for (pid_t pid : children) waitpid(pid, nullptr, 0);
+      return status;
+   }
+
+   cerr << "Usage: " << argv[0] << " coordinator <file> <port> [lease size] [lease timeout]"
+        << " | worker <host> <port> [worker id] | local <file> [workers] [lease size] [die after]" << endl;
+   return 1;
+}
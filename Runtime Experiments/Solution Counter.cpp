@@ -0,0 +1,386 @@
+// Exact and approximate counting of the solutions of sudoku grids of any box size (9x9, 16x16, 25x25, ...).
+//
+// Both counters use the same propagation as the Probing Solver: the candidates of each cell are held as a bitmask, a
+// cell with one candidate left has it removed from its peers, and a digit with only one place left in a unit is
+// placed there. The exact counter searches the whole tree, branching on the cell with the fewest candidates, which is
+// only practical while the number of solutions stays small.
+//
+// The approximate counter uses sequential importance sampling (Knuth's estimator, as in "Batch Runner.cpp", but
+// counting solutions instead of nodes). A sample walks from the root to a leaf: at each node it propagates every
+// candidate of the branching cell, keeps those that do not lead to a contradiction, multiplies its weight by their
+// number and follows one of them at random. A sample that reaches a complete grid has the product as its estimate,
+// and one that reaches a dead end has 0. The mean of the samples is an unbiased estimate of the number of solutions,
+// and a 95% confidence interval is given by the normal approximation from their sample variance. Samples are
+// independent, so they are split across threads, each with its own random number generator. Counts are held as long
+// doubles, since those of sparse 25x25 grids can be beyond the range of a double.
+//
+// Puzzles are read one per line, with n*n cells for an n x n grid (81, 256 or 625 characters). Digits are written
+// 1-9 and then A-Z for 10 onwards, and empty cells as '.' or '0'.
+//
+// Compile with: g++ -O2 -pthread -o counter "Solution Counter.cpp"
+//
+// Usage:
+//   ./counter exact <file> [limit]                     counts solutions exactly, stopping at the limit
+//                                                      (default 10^9).
+//   ./counter estimate <file> [samples] [threads]      estimates the number of solutions (default 10000 samples).
+//   ./counter compare <file> [puzzles] [holes] [threads]
+//                                                      removes the given number of givens (default 6) from the
+//                                                      first puzzles of a 9x9 file (default 20), counts their
+//                                                      solutions exactly, and reports the error, confidence
+//                                                      interval coverage and time of the estimate for increasing
+//                                                      numbers of samples.
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+using namespace std;
+
+// Rows, columns and boxes of a grid with the given box size, and the peers of each cell.
+struct Geometry {
+   int box, n, cells;
+   vector< vector<int> > units, units_of, peers;
+
+   explicit Geometry(int b);
+};
+
+Geometry::Geometry(int b) : box(b), n(b*b), cells(b*b*b*b), units(3*b*b), units_of(b*b*b*b), peers(b*b*b*b) {
+   for (int r = 0; r < n; r++) {
+      for (int c = 0; c < n; c++) {
+         const int k = r*n + c;
+         const int x[3] = {r, n + c, 2*n + (r/box)*box + c/box};
+         for (int u : x) {
+            units[u].push_back(k);
+            units_of[k].push_back(u);
+         }
+      }
+   }
+   for (int k = 0; k < cells; k++) {
+      for (int u : units_of[k]) {
+         for (int k2 : units[u]) {
+            if (k2 != k && find(peers[k].begin(), peers[k].end(), k2) == peers[k].end()) peers[k].push_back(k2);
+         }
+      }
+   }
+}
+
+// Candidates of every cell of a grid, with the cells reduced to one candidate whose peers are still to be updated.
+class State {
+   const Geometry* _g;
+   vector<uint32_t> _cand;
+   vector<int> _queue;
+
+public:
+   explicit State(const Geometry& g) : _g(&g), _cand(g.cells, g.n == 32 ? ~0u : (1u << g.n) - 1) {}
+
+   uint32_t cand(int k) const { return _cand[k]; }
+
+   // Removes the candidates in bits from cell k. Returns false if the cell is left with no candidates.
+   bool remove(int k, uint32_t bits) {
+      if (!(_cand[k] & bits)) return true;
+      _cand[k] &= ~bits;
+      if (_cand[k] == 0) return false;
+      if ((_cand[k] & (_cand[k] - 1)) == 0) _queue.push_back(k);
+      return true;
+   }
+
+   bool assign(int k, uint32_t bit) { return remove(k, _cand[k] & ~bit); }
+
+   // Propagates naked and hidden singles to a fixpoint. Returns false on a contradiction.
+   bool propagate();
+
+   // Returns the unsolved cell with the fewest candidates, or -1 if every cell is solved.
+   int least_count() const;
+};
+
+bool State::propagate() {
+   const uint32_t all = _g->n == 32 ? ~0u : (1u << _g->n) - 1;
+   for (;;) {
+      while (!_queue.empty()) {
+         const int k = _queue.back();
+         _queue.pop_back();
+         for (int p : _g->peers[k]) {
+            if (!remove(p, _cand[k])) return false;
+         }
+      }
+
+      // Hidden singles: digits that appear in exactly one cell of a unit.
+      bool placed = false;
+      for (const vector<int>& unit : _g->units) {
+         uint32_t once = 0, twice = 0, fixed = 0;
+         for (int k : unit) {
+            twice |= once & _cand[k];
+            once |= _cand[k];
+            if ((_cand[k] & (_cand[k] - 1)) == 0) fixed |= _cand[k];
+         }
+         if (once != all) return false;
+         uint32_t hidden = once & ~twice & ~fixed;
+         while (hidden) {
+            const uint32_t bit = hidden & -hidden;
+            hidden &= hidden - 1;
+            for (int k : unit) {
+               if (_cand[k] & bit) {
+                  remove(k, _cand[k] & ~bit);
+                  placed = true;
+               }
+            }
+         }
+      }
+      if (!placed) return true;
+   }
+}
+
+int State::least_count() const {
+   int k = -1, min = 33;
+   for (int i = 0; i < _g->cells; i++) {
+      const int m = __builtin_popcount(_cand[i]);
+      if (m > 1 && m < min) {
+         min = m, k = i;
+         if (m == 2) break;
+      }
+   }
+   return k;
+}
+
+// ======================================= Exact Counter ==========================================
+
+// Adds the number of solutions below the state to count, stopping once it reaches the limit.
+void count_exact(State s, long double& count, long double limit) {
+   if (!s.propagate()) return;
+   const int k = s.least_count();
+   if (k == -1) {
+      count += 1;
+      return;
+   }
+   uint32_t cands = s.cand(k);
+   while (cands && count < limit) {
+      const uint32_t bit = cands & -cands;
+      cands &= cands - 1;
+      State child = s;
+      if (child.assign(k, bit)) count_exact(child, count, limit);
+   }
+}
+
+// ====================================== Approximate Counter =====================================
+
+// One importance sample: the product of the number of consistent children along a random path from the state to
+// a leaf, or 0 if the path ends in a contradiction.
+long double sample(State s, mt19937_64& rng) {
+   long double weight = 1;
+   if (!s.propagate()) return 0;
+   vector<State> children;
+   for (;;) {
+      const int k = s.least_count();
+      if (k == -1) return weight;
+
+      children.clear();
+      uint32_t cands = s.cand(k);
+      while (cands) {
+         const uint32_t bit = cands & -cands;
+         cands &= cands - 1;
+         State child = s;
+         if (child.assign(k, bit) && child.propagate()) children.push_back(child);
+      }
+      if (children.empty()) return 0;
+      weight *= children.size();
+      s = children[uniform_int_distribution<size_t>(0, children.size() - 1)(rng)];
+   }
+}
+
+// Estimated number of solutions with its standard error and 95% confidence interval.
+struct CountEstimate {
+   long double mean = 0, standard_error = 0, low = 0, high = 0;
+   long samples = 0;
+   double seconds = 0;
+};
+
+// Draws the samples on the given number of threads. Thread t draws a fixed share of the samples, from
+// samples*t/threads up to samples*(t+1)/threads, with the seed (seed, t), so the estimate is reproducible for a
+// given number of threads.
+CountEstimate estimate_count(const State& root, long samples, int threads, uint64_t seed) {
+   vector<long double> sum(threads, 0), sum_sq(threads, 0);
+   auto start = chrono::steady_clock::now();
+
+   auto worker = [&](int t) {
+      seed_seq s{(uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)t};
+      mt19937_64 rng(s);
+      const long first = samples * t / threads, last = samples * (t + 1) / threads;
+      for (long i = first; i < last; i++) {
+         const long double x = sample(root, rng);
+         sum[t] += x;
+         sum_sq[t] += x * x;
+      }
+   };
+   vector<thread> pool;
+   for (int t = 0; t < threads; t++) pool.emplace_back(worker, t);
+   for (thread& t : pool) t.join();
+
+   CountEstimate e;
+   long double total = 0, total_sq = 0;
+   for (int t = 0; t < threads; t++) total += sum[t], total_sq += sum_sq[t];
+   e.samples = samples;
+   e.mean = total / samples;
+   const long double variance = samples > 1 ? max((long double)0, (total_sq - samples * e.mean * e.mean) / (samples - 1)) : 0;
+   e.standard_error = sqrtl(variance / samples);
+   e.low = max((long double)0, e.mean - 1.96L * e.standard_error);
+   e.high = e.mean + 1.96L * e.standard_error;
+   e.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+   return e;
+}
+
+// ==================================== Reading Puzzles ===========================================
+
+// Sets up the state of a puzzle line. Returns false if the givens contradict each other.
+bool read_puzzle(const string& line, const Geometry& g, State& s) {
+   for (int k = 0; k < g.cells; k++) {
+      const char c = line[k];
+      int d = 0;
+      if (c >= '1' && c <= '9') d = c - '0';
+      else if (c >= 'A' && c <= 'Z') d = 10 + c - 'A';
+      else if (c >= 'a' && c <= 'z') d = 10 + c - 'a';
+      if (d > g.n) return false;
+      if (d > 0 && !s.assign(k, 1u << (d - 1))) return false;
+   }
+   return true;
+}
+
+// Returns the box size of a puzzle line from the number of cells it starts with (anything after them, such as
+// the other columns of Data Set 3, is ignored), or 0 if that is not a square grid of at most 32 digits.
+int box_size(const string& line) {
+   size_t cells = 0;
+   while (cells < line.size() && (isalnum((unsigned char)line[cells]) || line[cells] == '.')) cells++;
+   for (int b = 2; b * b <= 32; b++) {
+      if (cells == (size_t)(b*b*b*b)) return b;
+   }
+   return 0;
+}
+
+string format(long double x) {
+   char buffer[64];
+   snprintf(buffer, sizeof(buffer), "%.6Lg", x);
+   return buffer;
+}
+
+//===================================== Driver Code ============================================
+int main(int argc, char* argv[]) {
+
+   if (argc < 3 || (strcmp(argv[1], "exact") && strcmp(argv[1], "estimate") && strcmp(argv[1], "compare"))) {
+      cerr << "Usage: " << argv[0] << " exact <file> [limit] | estimate <file> [samples] [threads]"
+           << " | compare <file> [puzzles] [holes] [threads]" << endl;
+      return 1;
+   }
+   const string mode = argv[1];
+
+   ifstream file_to_open(argv[2]);
+   if (!file_to_open) {
+      cerr << "Could not open " << argv[2] << endl;
+      return 1;
+   }
+   vector<string> lines;
+   string line;
+   while (getline(file_to_open, line)) {
+      if (box_size(line) > 0) lines.push_back(line);
+   }
+
+   const int default_threads = max(1u, thread::hardware_concurrency());
+
+   if (mode == "exact") {
+      const long double limit = argc > 3 ? stold(argv[3]) : 1e9L;
+      cout << "puzzle,solutions,time" << endl;
+      for (size_t i = 0; i < lines.size(); i++) {
+         const Geometry g(box_size(lines[i]));
+         State s(g);
+         long double count = 0;
+         auto start = chrono::steady_clock::now();
+         if (read_puzzle(lines[i], g, s)) count_exact(s, count, limit);
+         cout << i + 1 << "," << format(count) << (count >= limit ? "+" : "") << "," << fixed
+              << chrono::duration<double>(chrono::steady_clock::now() - start).count() << endl;
+         cout.unsetf(ios::fixed);
+      }
+      return 0;
+   }
+
+   if (mode == "estimate") {
+      const long samples = argc > 3 ? stol(argv[3]) : 10000;
+      const int threads = argc > 4 ? stoi(argv[4]) : default_threads;
+      if (samples < 1 || threads < 1) {
+         cerr << "The numbers of samples and threads must be at least 1" << endl;
+         return 1;
+      }
+      cout << "puzzle,estimate,standard error,95% low,95% high,samples,time" << endl;
+      for (size_t i = 0; i < lines.size(); i++) {
+         const Geometry g(box_size(lines[i]));
+         State s(g);
+         CountEstimate e;
+         if (read_puzzle(lines[i], g, s)) e = estimate_count(s, samples, threads, i);
+         cout << i + 1 << "," << format(e.mean) << "," << format(e.standard_error) << "," << format(e.low) << ","
+              << format(e.high) << ","
+              << samples << "," << fixed << e.seconds << endl;
+         cout.unsetf(ios::fixed);
+      }
+      return 0;
+   }
+
+   // Comparison against the exact counter on 9x9 puzzles with some of their givens removed.
+   const size_t puzzles = min(lines.size(), (size_t)(argc > 3 ? stoul(argv[3]) : 20));
+   const int holes = argc > 4 ? stoi(argv[4]) : 6;
+   const int threads = argc > 5 ? stoi(argv[5]) : default_threads;
+   const Geometry g(3);
+
+   vector<State> roots;
+   vector<long double> exact;
+   double exact_time = 0;
+   for (size_t i = 0; i < puzzles; i++) {
+      if (box_size(lines[i]) != 3) continue;
+      string p = lines[i].substr(0, 81);
+      vector<int> givens;
+      for (int k = 0; k < 81; k++) {
+         if (p[k] >= '1' && p[k] <= '9') givens.push_back(k);
+      }
+      mt19937 rng(i);
+      shuffle(givens.begin(), givens.end(), rng);
+      for (int h = 0; h < holes && h < (int)givens.size(); h++) p[givens[h]] = '.';
+
+      State s(g);
+      if (!read_puzzle(p, g, s)) continue;
+      long double count = 0;
+      auto start = chrono::steady_clock::now();
+      count_exact(s, count, 1e12L);
+      exact_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+      roots.push_back(s);
+      exact.push_back(count);
+   }
+   if (roots.empty()) {
+      cerr << "No 9x9 puzzles in " << argv[2] << endl;
+      return 1;
+   }
+
+   long double mean_solutions = 0;
+   for (long double c : exact) mean_solutions += c / exact.size();
+   cerr << "Puzzles: " << roots.size() << ", givens removed: " << holes << ", mean solutions: " << format(mean_solutions)
+        << endl;
+
+   cout << "counter,samples,mean time,mean relative error,95% interval coverage" << endl;
+   cout << "exact,," << fixed << exact_time / roots.size() << ",0,1" << endl;
+   for (long samples : {10L, 100L, 1000L, 10000L}) {
+      double time = 0, error = 0;
+      int covered = 0;
+      for (size_t i = 0; i < roots.size(); i++) {
+         const CountEstimate e = estimate_count(roots[i], samples, threads, i);
+         time += e.seconds;
+         error += (double)(fabsl(e.mean - exact[i]) / exact[i]);
+         covered += e.low <= exact[i] && exact[i] <= e.high;
+      }
+      cout << "estimate," << samples << "," << time / roots.size() << "," << error / roots.size() << ","
+           << (double)covered / roots.size() << endl;
+   }
+   return 0;
+}
@@ -0,0 +1,305 @@
+# Experiment to determine how often a Dantzig-Wolfe reformulation of the sudoku LP is integral,
+# compared with the compact LP of "Linear Programming Problem.py".
+
+# In the reformulation each column is a complete placement of one digit: nine cells, one in each row, column and
+# box, that contains every given of that digit and no cell given a different digit or sharing a unit with a given
+# of that digit. The LP chooses a convex combination of placements for each digit (one convexity constraint per
+# digit) such that every cell is covered exactly once (one covering constraint per cell). Any solution of this LP
+# gives a solution of the compact LP, so whenever the compact LP is integral so is this one.
+
+# An LP may have fractional vertices as well as the integer one, and the solver returns whichever it reaches, so
+# the vertex returned compares the luck of the solver rather than the formulations. As in "LP Insufficient
+# Cores.py", each LP is instead maximised over the variables that are 0 in the unique solution s of the puzzle
+# (for the reformulation, the cells of each chosen placement that do not hold its digit in s). The LP is integral
+# exactly when the maximum is 0, i.e. when s is its only feasible point.
+
+# There are up to 46656 placements per digit, so the LP is solved by column generation. The restricted master LP
+# starts with an artificial variable of cost 1 in each constraint, and after each solve the placement with the most
+# negative reduced cost is added for every digit that has one. The reduced cost of a placement p of digit d is
+# cost[p] - (mu[d] + sum of pi[k] over its cells), where mu and pi are the duals of the convexity and covering
+# constraints. The valid placements of each digit are found once per puzzle by a depth-first search over the rows,
+# and are priced together on each iteration as one matrix-vector product with the duals. Column generation first
+# minimises the artificial variables with every placement costing 0; the LP is feasible if they are then all 0.
+# They are then fixed at 0 and column generation continues with each placement costing minus the number of its
+# cells that do not hold its digit in s.
+
+# To be run on files within Data Set 3.
+
+import time
+import numpy as np
+import gurobipy as gp
+from gurobipy import GRB
+
+# Tolerance below which a value is treated as 0.
+eps = 1e-6
+
+# The box of each cell.
+box_of = [(k // 27) * 3 + (k % 9) // 3 for k in range(81)]
+
+
+def find_solution(puzzle):
+    '''
+    Finds a solution of the puzzle by depth-first search, branching on the cell with the fewest candidates.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+
+    Outputs:
+    solution: String of 81 digits, or None if the puzzle has no solution.
+    '''
+    grid = [0 if c in '.0' else int(c) for c in puzzle]
+    peers = [[k2 for k2 in range(81) if k2 != k and (k2 // 9 == k // 9 or k2 % 9 == k % 9
+              or box_of[k2] == box_of[k])] for k in range(81)]
+
+    def search():
+        best, best_cands = None, None
+        for k in range(81):
+            if grid[k] == 0:
+                cands = set(range(1, 10)) - {grid[k2] for k2 in peers[k]}
+                if best is None or len(cands) < len(best_cands):
+                    best, best_cands = k, cands
+        if best is None:
+            return(True)
+        for d in sorted(best_cands):
+            grid[best] = d
+            if search():
+                return(True)
+            grid[best] = 0
+        return(False)
+
+    return(''.join(str(d) for d in grid) if search() else None)
+
+
+def allowed_cells(puzzle):
+    '''
+    Finds the cells each digit may be placed in, given the givens of the puzzle.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+
+    Outputs:
+    allowed: List of 9 sets; allowed[d] holds the cells (0-80) that may hold digit d+1.
+    '''
+    allowed = []
+    for d in range(9):
+        given = [k for k in range(81) if puzzle[k] == str(d + 1)]
+        cells = set(given)
+        for k in range(81):
+            if puzzle[k] in '.0' and not any(k // 9 == g // 9 or k % 9 == g % 9 or box_of[k] == box_of[g]
+                                             for g in given):
+                cells.add(k)
+        allowed.append(cells)
+    return(allowed)
+
+
+def enumerate_placements(cells):
+    '''
+    Finds every placement of one digit within the allowed cells by a depth-first search over the rows,
+    choosing one cell per row in a column and box not already used.
+
+    Inputs:
+    cells: Set of the cells (0-80) the digit may be placed in.
+
+    Outputs:
+    placements: 0/1 matrix with one row per placement and one column per cell.
+    '''
+    by_row = [[k for k in range(r*9, r*9 + 9) if k in cells] for r in range(9)]
+    placements = []
+    chosen = []
+
+    def dfs(r, cols, boxes):
+        if r == 9:
+            placements.append(list(chosen))
+            return
+        for k in by_row[r]:
+            if not (cols >> (k % 9)) & 1 and not (boxes >> box_of[k]) & 1:
+                chosen.append(k)
+                dfs(r + 1, cols | 1 << (k % 9), boxes | 1 << box_of[k])
+                chosen.pop()
+
+    dfs(0, 0, 0)
+    matrix = np.zeros((len(placements), 81))
+    for i, p in enumerate(placements):
+        matrix[i, p] = 1
+    return(matrix)
+
+
+def column_generation(puzzle,solution):
+    '''
+    Solves the Dantzig-Wolfe reformulation of the LP of the puzzle by column generation, maximising the cells of
+    the chosen placements that do not hold their digit in the solution.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+    solution: String of the 81 digits of the unique solution of the puzzle.
+
+    Outputs:
+    integral: True if the LP is feasible and the solution is its only feasible point.
+    iterations: Number of times the restricted master LP was solved.
+    columns: Number of placements added to the restricted master LP.
+    '''
+    placements = [enumerate_placements(cells) for cells in allowed_cells(puzzle)]
+    if any(len(p) == 0 for p in placements):
+        return(False, 0, 0)
+
+    # Number of cells of each placement that do not hold its digit in the solution.
+    wrong = [9 - placements[d] @ np.array([solution[k] == str(d + 1) for k in range(81)]) for d in range(9)]
+
+    # Creating an empty model.
+    model = gp.Model('Sudoku Column Generation')
+
+    # Turns off printing to console.
+    # This line can be commented out if further details about the model are required.
+    model.Params.LogToConsole = 0
+
+    # Updates the above parameter of the model.
+    model.update()
+
+    # Artificial variables make the restricted master LP feasible before any placement has been added.
+    a = model.addVars(81, lb=0, obj=1, name='a')
+    b = model.addVars(9, lb=0, obj=1, name='b')
+
+    # Every cell is covered by exactly one placement.
+    cover = model.addConstrs((a[k] == 1 for k in range(81)), name='Cell')
+
+    # The placements of each digit form a convex combination.
+    convex = model.addConstrs((b[d] == 1 for d in range(9)), name='Digit')
+
+    model.ModelSense = GRB.MINIMIZE
+    model.update()
+
+    # The placement of each column, as (digit, row of the placement matrix of the digit).
+    added = []
+    lam = []
+    iterations = 0
+
+    def generate(cost):
+        # Adds the placement of most negative reduced cost for each digit until none has one.
+        nonlocal iterations
+        while True:
+            model.optimize()
+            iterations += 1
+            pi = np.array([cover[k].Pi for k in range(81)])
+
+            new_columns = 0
+            for d in range(9):
+                # Reduced cost of every placement of d at once; the most negative one enters the LP.
+                reduced = cost[d] - (placements[d] @ pi + convex[d].Pi)
+                best = int(np.argmin(reduced))
+                if reduced[best] < -eps:
+                    cells = np.flatnonzero(placements[d][best])
+                    column = gp.Column([1.0] * 10, [convex[d]] + [cover[k] for k in cells])
+                    lam.append(model.addVar(lb=0, obj=cost[d][best], column=column))
+                    added.append((d, best))
+                    new_columns += 1
+
+            if new_columns == 0:
+                return
+
+    # Phase 1: the LP is infeasible if the artificial variables cannot all be driven to 0.
+    generate([np.zeros(len(p)) for p in placements])
+    if model.objVal > eps:
+        return(False, iterations, len(added))
+
+    # Phase 2: maximise the cells of the chosen placements that do not hold their digit in the solution.
+    for var in list(a.values()) + list(b.values()):
+        var.ub = 0
+    for (d, i), var in zip(added, lam):
+        var.obj = -wrong[d][i]
+    generate([-w for w in wrong])
+    return(-model.objVal <= eps, iterations, len(added))
+
+
+def compact_lp(puzzle,solution):
+    '''
+    Solves the compact LP of the puzzle, as in "Linear Programming Problem.py", maximising the variables that are
+    0 in the solution.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+    solution: String of the 81 digits of the unique solution of the puzzle.
+
+    Outputs:
+    integral: True if the LP is feasible and the solution is its only feasible point.
+    '''
+    model = gp.Model('Sudoku Solver')
+    model.Params.LogToConsole = 0
+    model.update()
+
+    x = model.addVars(9, 9, 9, lb=0, ub=1, vtype=GRB.CONTINUOUS, name='x')
+    for k in range(81):
+        if puzzle[k] not in '.0':
+            x[k // 9, k % 9, int(puzzle[k]) - 1].lb = 1
+
+    model.addConstrs((x.sum(i, '*', d) == 1 for i in range(9) for d in range(9)), name='Row')
+    model.addConstrs((x.sum('*', j, d) == 1 for j in range(9) for d in range(9)), name='Column')
+    model.addConstrs((sum(x[i, j, d] for i in range(r*3, (r+1)*3) for j in range(c*3, (c+1)*3)) == 1
+                      for d in range(9) for r in range(3) for c in range(3)), name='Box')
+    model.addConstrs((x.sum(i, j, '*') == 1 for i in range(9) for j in range(9)), name='Cell')
+    model.setObjective(gp.quicksum(x[k // 9, k % 9, d] for k in range(81) for d in range(9)
+                                   if solution[k] != str(d + 1)), GRB.MAXIMIZE)
+    model.optimize()
+
+    if model.status != GRB.Status.OPTIMAL:
+        return(False)
+    return(model.objVal <= eps)
+
+#============================================Driver Code======================================================
+
+# Data Set 3.
+files = ["Intermediate Sudokus Correct.txt", "Expert Sudokus Correct.txt"]
+
+for file in files:
+
+    # To open the text file containing the sudoku puzzles.
+    f = open(file)
+
+    # Stores the number of sudoku whose LP is integral for each LP, and the time taken by each.
+    total = 0
+    compact_count = 0
+    cg_count = 0
+    compact_time = 0
+    cg_time = 0
+    iterations_total = 0
+    columns_total = 0
+
+    while True:
+        line = f.readline()
+
+        # Terminates the loop when all sudokus have been considered.
+        if not line:
+            break
+
+        # The puzzle is the first column of the file.
+        puzzle = line.strip().split(",")[0]
+        solution = find_solution(puzzle)
+        total += 1
+
+        start = time.perf_counter()
+        compact_count += compact_lp(puzzle,solution)
+        compact_time += time.perf_counter() - start
+
+        start = time.perf_counter()
+        integral, iterations, columns = column_generation(puzzle,solution)
+        cg_time += time.perf_counter() - start
+        cg_count += integral
+        iterations_total += iterations
+        columns_total += columns
+
+        # Outputs the sudoku puzzles whose reformulated LP is not integral.
+        if not integral:
+            print("Following sudoku has fractional solutions to the column generation LP:")
+            print(puzzle)
+
+    f.close()
+
+    print(file)
+    print("Number of sudokus:", total)
+    print("Number of sudokus whose compact LP is integral:", compact_count)
+    print("Number of sudokus whose column generation LP is integral:", cg_count)
+    print("Average number of master LPs solved per sudoku:", iterations_total / total)
+    print("Average number of columns generated per sudoku:", columns_total / total)
+    print("Average time per sudoku for the compact LP (seconds):", compact_time / total)
+    print("Average time per sudoku for column generation (seconds):", cg_time / total)
+
+print("Completed.")
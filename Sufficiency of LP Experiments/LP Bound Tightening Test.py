@@ -0,0 +1,273 @@
+# Experiment to determine how many sudoku puzzles are fully solved by LP bound tightening together with singles.
+
+# A candidate x[i,j,k] whose maximum over the feasible region of the LP is 0 can never be part of a solution and
+# can be eliminated. Each remaining candidate is maximised in turn on one model, changing only the objective,
+# so every re-solve is warm-started by Gurobi from the basis of the previous one. A candidate that takes a
+# positive value in any solution found along the way has been proven to have a positive maximum and does not
+# need to be maximised itself. Eliminated candidates are then propagated with naked and hidden singles, and
+# the process is repeated until no more candidates are eliminated.
+
+# To be run on files within Data Set 3.
+
+import time
+import numpy as np
+import gurobipy as gp
+from gurobipy import GRB
+
+# Tolerance below which the value of a variable is treated as 0.
+eps = 1e-6
+
+# The rows, columns and boxes (units) of the 9x9 grid as lists of cell indices, the units each cell belongs to
+# and the peers of each cell (the cells sharing a unit with it).
+units = ([[r*9 + c for c in range(9)] for r in range(9)] +
+         [[r*9 + c for r in range(9)] for c in range(9)] +
+         [[(br*3 + r)*9 + bc*3 + c for r in range(3) for c in range(3)] for br in range(3) for bc in range(3)])
+units_of = [[u for u in units if k in u] for k in range(81)]
+peers = [set(k2 for u in units_of[k] for k2 in u if k2 != k) for k in range(81)]
+
+
+def assign(cands,k,d):
+    '''
+    Places digit d in cell k by eliminating every other candidate of the cell.
+
+    Inputs:
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    k: Index of the cell (0-80).
+    d: Digit to be placed (1-9).
+
+    Outputs:
+    True if no contradiction was found while propagating, False otherwise.
+    '''
+    return all(eliminate(cands,k,d2) for d2 in list(cands[k]) if d2 != d)
+
+
+def eliminate(cands,k,d):
+    '''
+    Removes digit d from the candidates of cell k and propagates the consequences with naked and hidden singles.
+
+    Inputs:
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    k: Index of the cell (0-80).
+    d: Digit to be eliminated (1-9).
+
+    Outputs:
+    True if no contradiction was found while propagating, False otherwise.
+    '''
+    if d not in cands[k]:
+        return True
+    cands[k].discard(d)
+
+    # Naked singles: a cell with one candidate left has that digit removed from all of its peers.
+    if len(cands[k]) == 0:
+        return False
+    if len(cands[k]) == 1:
+        d2 = next(iter(cands[k]))
+        if not all(eliminate(cands,k2,d2) for k2 in peers[k]):
+            return False
+
+    # Hidden singles: a unit with only one place left for d has d placed there.
+    for u in units_of[k]:
+        places = [k2 for k2 in u if d in cands[k2]]
+        if len(places) == 0:
+            return False
+        if len(places) == 1 and len(cands[places[0]]) > 1:
+            if not assign(cands,places[0],d):
+                return False
+    return True
+
+
+def build_model(m):
+    '''
+    Builds the LP relaxation of the puzzle, as in "Linear Programming Problem.py". The givens and eliminated
+    candidates are set afterwards through the bounds of the variables (see set_bounds).
+
+    Inputs:
+    m: Integer representing the number of digits 1,...,m placed within the grid,
+       as well as the number of rows, columns and boxes in the grid.
+
+    Outputs:
+    model: The Gurobi model.
+    x: The decision variables of the model.
+    '''
+    # Number of rows and columns in a box.
+    p = int(np.sqrt(m))
+
+    # Creating an empty model.
+    model = gp.Model('Sudoku Solver')
+
+    # Turns off printing to console.
+    # This line can be commented out if further details about the model are required.
+    model.Params.LogToConsole = 0
+
+    # Only the objective changes between solves, so the previous basis stays primal feasible
+    # and the primal simplex method can continue from it.
+    model.Params.Method = 0
+
+    # Updates the above parameters of the model.
+    model.update()
+
+    # Defining the decision variables.
+    x = model.addVars(m, m, m, lb=0, ub=1, vtype=GRB.CONTINUOUS, name='x')
+
+    # Only one of each number can be found in a row.
+    model.addConstrs((x.sum(i, '*', k) == 1 for i in range(m) for k in range(m)), name='Row')
+
+    # Only one of each number can be found in a column.
+    model.addConstrs((x.sum('*', j, k) == 1 for j in range(m) for k in range(m)), name='Column')
+
+    # Only one of each number can be found in a box.
+    model.addConstrs((sum(x[i, j, k] for i in range(r*p, (r+1)*p)
+                    for j in range(c*p, (c+1)*p)) == 1 for k in range(m) for r in range(p)
+                    for c in range(p)), name='Box')
+
+    # Each cell within the grid must have a number assigned to it.
+    model.addConstrs((x.sum(i, j, '*') == 1 for i in range(m) for j in range(m)), name='Cell')
+
+    model.update()
+    return(model,x)
+
+
+def set_bounds(x,cands,m,current):
+    '''
+    Sets the bounds of the variables to match the remaining candidates. Only bounds that differ from
+    those of the previous LP are changed, so that the re-solve stays warm.
+
+    Inputs:
+    x: The decision variables of the model.
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    m: Integer representing the number of digits 1,...,m placed within the grid.
+    current: Dictionary holding the (lower, upper) bounds currently set on each variable. Updated in place.
+    '''
+    for k in range(81):
+        i, j = k // m, k % m
+        for d in range(1, m + 1):
+            ub = 1 if d in cands[k] else 0
+            lb = 1 if cands[k] == {d} else 0
+            if current.get((i, j, d - 1)) != (lb, ub):
+                x[i, j, d - 1].lb = lb
+                x[i, j, d - 1].ub = ub
+                current[i, j, d - 1] = (lb, ub)
+
+
+def mark_proven(sol,cands,proven):
+    '''
+    Adds every candidate that takes a positive value in an LP solution to the set of candidates proven
+    to have a positive maximum.
+    '''
+    for k in range(81):
+        for d in cands[k]:
+            if sol[k // 9, k % 9, d - 1] > eps:
+                proven.add((k, d))
+
+
+def bound_tightening(puzzle):
+    '''
+    Eliminates every candidate whose maximum over the LP feasible region is 0, propagating the eliminations
+    with singles, until no more candidates can be eliminated.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+
+    Outputs:
+    singles_solved: True if the puzzle is solved by singles alone.
+    solved: True if the puzzle is solved by LP bound tightening plus singles.
+    lp_solves: Number of LPs solved.
+    eliminated: Number of candidates eliminated by bound tightening.
+    '''
+    cands = [set(range(1, 10)) for k in range(81)]
+    if not all(assign(cands,k,int(puzzle[k])) for k in range(81) if puzzle[k] not in '.0'):
+        return(False, False, 0, 0)
+
+    singles_solved = all(len(c) == 1 for c in cands)
+
+    model, x = build_model(9)
+    current = {}
+    set_bounds(x,cands,9,current)
+
+    # Feasibility solve: every candidate positive in the solution has a positive maximum.
+    model.optimize()
+    lp_solves = 1
+    if model.status == GRB.Status.INFEASIBLE:
+        return(singles_solved, False, lp_solves, 0)
+    proven = set()
+    mark_proven(model.getAttr('X', x),cands,proven)
+
+    eliminated = 0
+    changed = True
+    while changed and not all(len(c) == 1 for c in cands):
+        changed = False
+        for k in range(81):
+            for d in sorted(cands[k]):
+                if len(cands[k]) == 1 or (k, d) in proven or d not in cands[k]:
+                    continue
+
+                # Maximise this candidate alone.
+                model.setObjective(x[k // 9, k % 9, d - 1], GRB.MAXIMIZE)
+                model.optimize()
+                lp_solves += 1
+
+                if model.objVal > eps:
+                    mark_proven(model.getAttr('X', x),cands,proven)
+                    continue
+
+                # The candidate is 0 over the whole feasible region: eliminate it and propagate.
+                eliminated += 1
+                changed = True
+                if not eliminate(cands,k,d):
+                    return(singles_solved, False, lp_solves, eliminated)
+                set_bounds(x,cands,9,current)
+
+    solved = all(len(c) == 1 for c in cands)
+    return(singles_solved, solved, lp_solves, eliminated)
+
+#============================================Driver Code======================================================
+
+# Data Set 3.
+files = ["Intermediate Sudokus Correct.txt", "Expert Sudokus Correct.txt"]
+
+for file in files:
+
+    # To open the text file containing the sudoku puzzles.
+    f = open(file)
+
+    # Stores the number of sudoku solved by singles alone, and by LP bound tightening plus singles.
+    total = 0
+    singles_count = 0
+    tightening_count = 0
+    lp_solves_total = 0
+    eliminated_total = 0
+    start = time.perf_counter()
+
+    while True:
+        line = f.readline()
+
+        # Terminates the loop when all sudokus have been considered.
+        if not line:
+            break
+
+        # The puzzle is the first column of the file.
+        puzzle = line.strip().split(",")[0]
+
+        singles_solved, solved, lp_solves, eliminated = bound_tightening(puzzle)
+        total += 1
+        singles_count += singles_solved
+        tightening_count += solved
+        lp_solves_total += lp_solves
+        eliminated_total += eliminated
+
+        # Outputs the sudoku puzzles that are not fully solved by LP bound tightening plus singles.
+        if not solved:
+            print("Following sudoku is not solved by LP bound tightening plus singles:")
+            print(puzzle)
+
+    f.close()
+
+    print(file)
+    print("Number of sudokus:", total)
+    print("Number of sudokus solved by singles alone:", singles_count)
+    print("Number of sudokus solved by LP bound tightening plus singles:", tightening_count)
+    print("Average number of LPs solved per sudoku:", lp_solves_total / total)
+    print("Average number of candidates eliminated by bound tightening per sudoku:", eliminated_total / total)
+    print("Time taken (seconds):", time.perf_counter() - start)
+
+print("Completed.")
@@ -0,0 +1,278 @@
+# Experiment comparing two ways of choosing where to branch when a propagation-and-search solver has to guess.
+# The solver propagates in the same way as the Norvig solver used in the runtime experiment (eliminating a placed digit
+# from all peers and placing a digit that has only one possible position in a row, column or box).
+
+# MRV branching (as in the Norvig solver): branch on the cell with the fewest remaining candidates, trying each in turn.
+# LP branching: solve the LP relaxation of the remaining puzzle and branch on the (cell, digit) with the largest
+# fractional value, first placing the digit and then eliminating it. The LP is solved at the root and at nodes
+# up to a chosen depth; deeper nodes fall back to MRV branching.
+
+# One model is built per puzzle and only the bounds of the variables are changed as the search moves around the tree,
+# so every re-solve is warm-started by Gurobi from the basis of the previous LP solved on the same model.
+
+# To be run on "Expert Sudokus Correct.txt" from Data Set 3.
+
+import time
+import numpy as np
+import gurobipy as gp
+from gurobipy import GRB
+
+# The rows, columns and boxes (units) of the 9x9 grid as lists of cell indices, the units each cell belongs to
+# and the peers of each cell (the cells sharing a unit with it).
+units = ([[r*9 + c for c in range(9)] for r in range(9)] +
+         [[r*9 + c for r in range(9)] for c in range(9)] +
+         [[(br*3 + r)*9 + bc*3 + c for r in range(3) for c in range(3)] for br in range(3) for bc in range(3)])
+units_of = [[u for u in units if k in u] for k in range(81)]
+peers = [set(k2 for u in units_of[k] for k2 in u if k2 != k) for k in range(81)]
+
+
+def assign(cands,k,d):
+    '''
+    Places digit d in cell k by eliminating every other candidate of the cell.
+
+    Inputs:
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    k: Index of the cell (0-80).
+    d: Digit to be placed (1-9).
+
+    Outputs:
+    True if no contradiction was found while propagating, False otherwise.
+    '''
+    return all(eliminate(cands,k,d2) for d2 in list(cands[k]) if d2 != d)
+
+
+def eliminate(cands,k,d):
+    '''
+    Removes digit d from the candidates of cell k and propagates the consequences.
+
+    Inputs:
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    k: Index of the cell (0-80).
+    d: Digit to be eliminated (1-9).
+
+    Outputs:
+    True if no contradiction was found while propagating, False otherwise.
+    '''
+    if d not in cands[k]:
+        return True
+    cands[k].discard(d)
+
+    # A cell with no candidates left is a contradiction, and a cell with one candidate left has that digit
+    # removed from all of its peers.
+    if len(cands[k]) == 0:
+        return False
+    if len(cands[k]) == 1:
+        d2 = next(iter(cands[k]))
+        if not all(eliminate(cands,k2,d2) for k2 in peers[k]):
+            return False
+
+    # A unit with no place left for d is a contradiction, and a unit with only one place left for d has d placed there.
+    for u in units_of[k]:
+        places = [k2 for k2 in u if d in cands[k2]]
+        if len(places) == 0:
+            return False
+        if len(places) == 1 and len(cands[places[0]]) > 1:
+            if not assign(cands,places[0],d):
+                return False
+    return True
+
+
+def build_model(m):
+    '''
+    Builds the LP relaxation of the puzzle, as in "Linear Programming Problem.py". The givens and eliminated
+    candidates are set afterwards through the bounds of the variables (see set_bounds).
+
+    Inputs:
+    m: Integer representing the number of digits 1,...,m placed within the grid,
+       as well as the number of rows, columns and boxes in the grid.
+
+    Outputs:
+    model: The Gurobi model.
+    x: The decision variables of the model.
+    '''
+    # Number of rows and columns in a box.
+    p = int(np.sqrt(m))
+
+    # Creating an empty model.
+    model = gp.Model('Sudoku Solver')
+
+    # Turns off printing to console.
+    # This line can be commented out if further details about the model are required.
+    model.Params.LogToConsole = 0
+
+    # The dual simplex method re-solves from the previous basis after bounds change.
+    model.Params.Method = 1
+
+    # Updates the above parameters of the model.
+    model.update()
+
+    # Defining the decision variables.
+    x = model.addVars(m, m, m, lb=0, ub=1, vtype=GRB.CONTINUOUS, name='x')
+
+    # Only one of each number can be found in a row.
+    model.addConstrs((x.sum(i, '*', k) == 1 for i in range(m) for k in range(m)), name='Row')
+
+    # Only one of each number can be found in a column.
+    model.addConstrs((x.sum('*', j, k) == 1 for j in range(m) for k in range(m)), name='Column')
+
+    # Only one of each number can be found in a box.
+    model.addConstrs((sum(x[i, j, k] for i in range(r*p, (r+1)*p)
+                    for j in range(c*p, (c+1)*p)) == 1 for k in range(m) for r in range(p)
+                    for c in range(p)), name='Box')
+
+    # Each cell within the grid must have a number assigned to it.
+    model.addConstrs((x.sum(i, j, '*') == 1 for i in range(m) for j in range(m)), name='Cell')
+
+    model.update()
+    return(model,x)
+
+
+def set_bounds(x,cands,m,current):
+    '''
+    Sets the bounds of the variables to match the candidates at the current node of the search tree.
+    Only bounds that differ from those of the previous LP are changed, so that the re-solve stays warm.
+
+    Inputs:
+    x: The decision variables of the model.
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    m: Integer representing the number of digits 1,...,m placed within the grid.
+    current: Dictionary holding the (lower, upper) bounds currently set on each variable. Updated in place.
+    '''
+    for k in range(81):
+        i, j = k // m, k % m
+        for d in range(1, m + 1):
+            ub = 1 if d in cands[k] else 0
+            lb = 1 if cands[k] == {d} else 0
+            if current.get((i, j, d - 1)) != (lb, ub):
+                x[i, j, d - 1].lb = lb
+                x[i, j, d - 1].ub = ub
+                current[i, j, d - 1] = (lb, ub)
+
+
+def search(cands,depth,mode,lp,stats):
+    '''
+    Depth-first search for the solution of the puzzle.
+
+    Inputs:
+    cands: List of 81 sets holding the candidates remaining in each cell after propagation.
+    depth: Number of branches between this node and the root.
+    mode: 'MRV' for MRV branching only, or the deepest depth at which the LP is solved for LP branching.
+    lp: Tuple (model, x, current bounds) holding the LP relaxation of the puzzle, or None for MRV branching.
+    stats: Dictionary counting the nodes visited and LP solves made.
+
+    Outputs:
+    The candidate sets of the solution, or None if this subtree contains no solution.
+    '''
+    stats['nodes'] += 1
+    if all(len(c) == 1 for c in cands):
+        return(cands)
+
+    if mode != 'MRV' and depth <= mode:
+        model, x, current = lp
+        set_bounds(x,cands,9,current)
+        model.optimize()
+        stats['lp_solves'] += 1
+
+        # The LP proves that no solution can be found below this node.
+        if model.status == GRB.Status.INFEASIBLE:
+            return(None)
+
+        # Branch on the unplaced (cell, digit) with the largest value, placing the digit first.
+        sol = model.getAttr('X', x)
+        best, k, d = -1, None, None
+        for k2 in range(81):
+            if len(cands[k2]) > 1:
+                for d2 in cands[k2]:
+                    if sol[k2 // 9, k2 % 9, d2 - 1] > best:
+                        best, k, d = sol[k2 // 9, k2 % 9, d2 - 1], k2, d2
+
+        left = [set(c) for c in cands]
+        if assign(left,k,d):
+            result = search(left,depth + 1,mode,lp,stats)
+            if result is not None:
+                return(result)
+        right = [set(c) for c in cands]
+        if eliminate(right,k,d):
+            return(search(right,depth + 1,mode,lp,stats))
+        return(None)
+
+    # MRV branching: the unplaced cell with the fewest candidates, trying each candidate in turn.
+    k = min((k2 for k2 in range(81) if len(cands[k2]) > 1), key=lambda k2: len(cands[k2]))
+    for d in sorted(cands[k]):
+        child = [set(c) for c in cands]
+        if assign(child,k,d):
+            result = search(child,depth + 1,mode,lp,stats)
+            if result is not None:
+                return(result)
+    return(None)
+
+
+def solve(puzzle,mode):
+    '''
+    Solves one sudoku puzzle with the chosen branching mode.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+    mode: 'MRV' for MRV branching only, or the deepest depth at which the LP is solved for LP branching.
+
+    Outputs:
+    stats: Dictionary holding the nodes visited, LP solves made, time taken and whether the solution was found.
+    '''
+    stats = {'nodes': 0, 'lp_solves': 0}
+    start = time.perf_counter()
+
+    cands = [set(range(1, 10)) for k in range(81)]
+    ok = all(assign(cands,k,int(puzzle[k])) for k in range(81) if puzzle[k] not in '.0')
+
+    lp = None
+    if ok and mode != 'MRV':
+        model, x = build_model(9)
+        lp = (model, x, {})
+        set_bounds(x,cands,9,lp[2])
+
+    result = search(cands,0,mode,lp,stats) if ok else None
+
+    stats['time'] = time.perf_counter() - start
+    stats['solved'] = result is not None
+    return(stats)
+
+#============================================Driver Code======================================================
+
+# To open the text file containing the sudoku puzzles.
+f = open("Expert Sudokus Correct.txt")
+
+# Branching modes compared: MRV only, the LP at the root only, and the LP at all nodes up to depth 3.
+modes = ['MRV', 0, 3]
+
+# Stores the total nodes, LP solves and time for each branching mode.
+totals = {mode: {'nodes': 0, 'lp_solves': 0, 'time': 0.0, 'unsolved': 0} for mode in modes}
+
+# Outputs one line per sudoku puzzle with the nodes visited and time taken by each branching mode.
+print("puzzle," + ",".join(f"{mode} nodes,{mode} time" for mode in modes))
+
+while True:
+    line = f.readline()
+
+    # Terminates the loop when all sudokus have been solved.
+    if not line:
+        print("Completed.")
+        break
+
+    # The puzzle is the first column of the file.
+    puzzle = line.strip().split(",")[0]
+
+    results = []
+    for mode in modes:
+        stats = solve(puzzle,mode)
+        for key in ('nodes', 'lp_solves', 'time'):
+            totals[mode][key] += stats[key]
+        if not stats['solved']:
+            totals[mode]['unsolved'] += 1
+        results.append(f"{stats['nodes']},{stats['time']:.6f}")
+
+    print(puzzle + "," + ",".join(results))
+
+for mode in modes:
+    name = "MRV branching" if mode == 'MRV' else f"LP branching up to depth {mode}"
+    print(f"{name}: {totals[mode]['nodes']} nodes, {totals[mode]['lp_solves']} LP solves, "
+          f"{totals[mode]['time']:.3f} seconds, {totals[mode]['unsolved']} unsolved")
@@ -0,0 +1,363 @@
+# Experiment to find, for each puzzle whose LP relaxation is insufficient, a minimal configuration (a core) that
+# is still a proper puzzle with an insufficient LP relaxation. Two kinds of core are found:
+# - Givens cores: minimal subsets of the givens. Removing a given often makes the puzzle improper, and the puzzles
+#   of Data Set 3 are mostly minimal puzzles, whose givens cores are the puzzles themselves.
+# - Hole cores: minimal subsets of the empty cells, with every other cell given its digit in the solution. These
+#   are always proper, since every given agrees with the unique solution, and show the smallest region of the
+#   grid on which the LP still fails.
+
+# A proper puzzle has exactly one solution s, which is a vertex of the LP of "Linear Programming Problem.py". The LP
+# is sufficient when s is its only feasible point; otherwise every other vertex is fractional (the only integer
+# point is s) and the solver may return one of them. This is tested without depending on which vertex the solver
+# happens to return, by maximising the sum of the variables that are 0 in s: the LP is insufficient exactly when
+# the maximum is positive. Every core has the same solution s, so the objective never changes. If the maximum is
+# 0 the puzzle is also known to be proper, since s is then the only integer point; otherwise the uniqueness of a
+# givens core is checked by a search with naked and hidden singles, stopping at a second solution.
+
+# Cores are found by delta debugging (the ddmin algorithm of Zeller and Hildebrandt, 2002). The cells are split
+# into n chunks, and the search moves to any chunk, or the complement of any chunk, that keeps the property,
+# doubling n when none does. The result is 1-minimal: removing any single cell from the core makes the puzzle
+# improper or its LP sufficient. Each configuration is tested by changing only the bounds of the cells that
+# differ from those of the previous test, on one model per puzzle. Changing bounds keeps the previous optimal
+# basis dual feasible, so every re-solve is warm-started by the dual simplex method.
+
+# Puzzles are processed in parallel, one per process. The cores are written to "LP Insufficient Cores.txt", one
+# per line as: kind of core, core, original puzzle, number of givens of each, LP solves, uniqueness checks,
+# fractional cells of the core's LP at the maximum, and seconds taken.
+
+# To be run on files within Data Set 3.
+
+import time
+import multiprocessing
+import numpy as np
+import gurobipy as gp
+from gurobipy import GRB
+
+# Tolerance below which a value is treated as 0.
+eps = 1e-6
+
+# No subset with fewer givens than this can be a proper puzzle.
+min_proper_givens = 17
+
+# The rows, columns and boxes (units) of the 9x9 grid as lists of cell indices, the units each cell belongs to
+# and the peers of each cell (the cells sharing a unit with it).
+units = ([[r*9 + c for c in range(9)] for r in range(9)] +
+         [[r*9 + c for r in range(9)] for c in range(9)] +
+         [[(br*3 + r)*9 + bc*3 + c for r in range(3) for c in range(3)] for br in range(3) for bc in range(3)])
+units_of = [[u for u in units if k in u] for k in range(81)]
+peers = [set(k2 for u in units_of[k] for k2 in u if k2 != k) for k in range(81)]
+
+
+def assign(cands,k,d):
+    '''
+    Places digit d in cell k by eliminating every other candidate of the cell.
+
+    Inputs:
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    k: Index of the cell (0-80).
+    d: Digit to be placed (1-9).
+
+    Outputs:
+    True if no contradiction was found while propagating, False otherwise.
+    '''
+    return all(eliminate(cands,k,d2) for d2 in list(cands[k]) if d2 != d)
+
+
+def eliminate(cands,k,d):
+    '''
+    Removes digit d from the candidates of cell k and propagates the consequences with naked and hidden singles.
+
+    Inputs:
+    cands: List of 81 sets holding the candidates remaining in each cell.
+    k: Index of the cell (0-80).
+    d: Digit to be eliminated (1-9).
+
+    Outputs:
+    True if no contradiction was found while propagating, False otherwise.
+    '''
+    if d not in cands[k]:
+        return True
+    cands[k].discard(d)
+
+    # A cell with no candidates left is a contradiction, and a cell with one candidate left has that digit
+    # removed from all of its peers.
+    if len(cands[k]) == 0:
+        return False
+    if len(cands[k]) == 1:
+        d2 = next(iter(cands[k]))
+        if not all(eliminate(cands,k2,d2) for k2 in peers[k]):
+            return False
+
+    # A unit with no place left for d is a contradiction, and a unit with only one place left for d has d placed there.
+    for u in units_of[k]:
+        places = [k2 for k2 in u if d in cands[k2]]
+        if len(places) == 0:
+            return False
+        if len(places) == 1 and len(cands[places[0]]) > 1:
+            if not assign(cands,places[0],d):
+                return False
+    return True
+
+
+def find_solutions(givens,limit):
+    '''
+    Finds up to limit solutions of a puzzle by depth-first search, branching on the cell with the fewest candidates.
+
+    Inputs:
+    givens: Dictionary mapping the cell (0-80) of each given to its digit.
+    limit: Number of solutions after which the search stops.
+
+    Outputs:
+    solutions: List of the solutions found, each a list of 81 digits.
+    '''
+    cands = [set(range(1, 10)) for k in range(81)]
+    if not all(assign(cands,k,d) for k, d in givens.items()):
+        return([])
+
+    solutions = []
+
+    def search(cands):
+        if all(len(c) == 1 for c in cands):
+            solutions.append([next(iter(c)) for c in cands])
+            return
+        k = min((k2 for k2 in range(81) if len(cands[k2]) > 1), key=lambda k2: len(cands[k2]))
+        for d in sorted(cands[k]):
+            child = [set(c) for c in cands]
+            if assign(child,k,d):
+                search(child)
+                if len(solutions) >= limit:
+                    return
+
+    search(cands)
+    return(solutions)
+
+
+def build_model(solution):
+    '''
+    Builds the LP relaxation of the puzzle, as in "Linear Programming Problem.py", with the objective of maximising
+    the sum of the variables that are 0 in the solution. The givens are set afterwards through the lower bounds of
+    the variables (see test_fixed).
+
+    Inputs:
+    solution: List of the 81 digits of the solution of the puzzle.
+
+    Outputs:
+    model: The Gurobi model.
+    x: The decision variables of the model.
+    '''
+    # Creating an empty model.
+    model = gp.Model('Sudoku Core')
+
+    # Turns off printing to console.
+    # This line can be commented out if further details about the model are required.
+    model.Params.LogToConsole = 0
+
+    # The dual simplex method re-solves from the previous basis after bounds change.
+    model.Params.Method = 1
+
+    # Updates the above parameters of the model.
+    model.update()
+
+    # Defining the decision variables.
+    x = model.addVars(9, 9, 9, lb=0, ub=1, vtype=GRB.CONTINUOUS, name='x')
+
+    # Only one of each number can be found in a row.
+    model.addConstrs((x.sum(i, '*', k) == 1 for i in range(9) for k in range(9)), name='Row')
+
+    # Only one of each number can be found in a column.
+    model.addConstrs((x.sum('*', j, k) == 1 for j in range(9) for k in range(9)), name='Column')
+
+    # Only one of each number can be found in a box.
+    model.addConstrs((sum(x[i, j, k] for i in range(r*3, (r+1)*3)
+                    for j in range(c*3, (c+1)*3)) == 1 for k in range(9) for r in range(3)
+                    for c in range(3)), name='Box')
+
+    # Each cell within the grid must have a number assigned to it.
+    model.addConstrs((x.sum(i, j, '*') == 1 for i in range(9) for j in range(9)), name='Cell')
+
+    model.setObjective(gp.quicksum(x[k // 9, k % 9, d] for k in range(81) for d in range(9)
+                                   if d != solution[k] - 1), GRB.MAXIMIZE)
+    model.update()
+    return(model,x)
+
+
+def test_fixed(fixed,solution,lp,stats,check_unique):
+    '''
+    Tests whether the puzzle with the given cells fixed to their digits in the solution is a proper puzzle with an
+    insufficient LP relaxation.
+
+    Inputs:
+    fixed: Frozen set of the cells (0-80) that are given.
+    solution: List of the 81 digits of the solution of the original puzzle.
+    lp: Tuple (model, x, cells currently given in the model). The set of cells is updated in place.
+    stats: Dictionary counting the LP solves and uniqueness checks made, and caching the result of each test.
+    check_unique: True if the puzzle may have more than one solution, so that uniqueness must be checked.
+
+    Outputs:
+    True if the puzzle keeps the property, False otherwise.
+    '''
+    if fixed in stats['cache']:
+        return(stats['cache'][fixed])
+
+    # Only the bounds of cells fixed or freed since the previous test are changed, so that the re-solve stays warm.
+    model, x, current = lp
+    for k in current - fixed:
+        x[k // 9, k % 9, solution[k] - 1].lb = 0
+    for k in fixed - current:
+        x[k // 9, k % 9, solution[k] - 1].lb = 1
+    current.clear()
+    current.update(fixed)
+
+    model.optimize()
+    stats['lp_solves'] += 1
+    result = model.objVal > eps
+    if result and check_unique:
+        stats['uniqueness_checks'] += 1
+        result = len(find_solutions({k: solution[k] for k in fixed},2)) == 1
+
+    stats['cache'][fixed] = result
+    return(result)
+
+
+def ddmin(cells,test,min_size):
+    '''
+    Reduces a set of cells to a 1-minimal subset that passes the test, by delta debugging.
+
+    Inputs:
+    cells: List of cells (0-80), which must pass the test.
+    test: Function taking a list of cells and returning True if it keeps the property.
+    min_size: Number of cells below which no subset can pass the test, so that smaller ones are not tested.
+
+    Outputs:
+    cells: List of the cells of the 1-minimal subset.
+    '''
+    n = 2
+    while len(cells) >= 2:
+        chunks = [cells[len(cells)*i // n:len(cells)*(i + 1) // n] for i in range(n)]
+        reduced = False
+
+        # Moves to a single chunk, if one is large enough and keeps the property.
+        for chunk in chunks:
+            if len(chunk) >= min_size and test(chunk):
+                cells, n, reduced = chunk, 2, True
+                break
+
+        # Otherwise moves to the complement of a chunk.
+        if not reduced:
+            for chunk in chunks:
+                complement = [k for k in cells if k not in chunk]
+                if len(complement) >= min_size and test(complement):
+                    cells, n, reduced = complement, max(n - 1, 2), True
+                    break
+
+        # Otherwise splits into smaller chunks, until every chunk is a single cell.
+        if not reduced:
+            if n >= len(cells):
+                break
+            n = min(len(cells), 2*n)
+    return(cells)
+
+
+def find_cores(puzzle):
+    '''
+    Finds the givens core and the hole core of one puzzle. Run in a separate process for each puzzle.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+
+    Outputs:
+    results: Dictionary holding, for each kind of core, a dictionary with the core (None if the LP of the puzzle
+             is sufficient or the puzzle is not proper), the LP solves and uniqueness checks made, the fractional
+             cells of the core's LP and the time taken.
+    '''
+    givens = [k for k in range(81) if puzzle[k] not in '.0']
+    holes = [k for k in range(81) if puzzle[k] in '.0']
+    results = {}
+
+    solutions = find_solutions({k: int(puzzle[k]) for k in givens},2)
+    model, x = build_model(solutions[0]) if len(solutions) == 1 else (None, None)
+    lp = (model, x, set())
+
+    # A givens core is a subset of the givens; a hole core is a subset of the empty cells, with the rest given.
+    for kind, cells, to_fixed, min_size in (('givens', givens, lambda c: frozenset(c), min_proper_givens),
+                                            ('holes', holes, lambda c: frozenset(range(81)) - frozenset(c), 1)):
+        start = time.perf_counter()
+        stats = {'lp_solves': 0, 'uniqueness_checks': 0, 'cache': {}}
+        result = {'core': None, 'fractional_cells': 0}
+        test = lambda c: test_fixed(to_fixed(c),solutions[0],lp,stats,kind == 'givens')
+
+        if model is not None and test(cells):
+            core = ddmin(cells,test,min_size)
+
+            # Re-solves the LP of the core, to report how many cells the fractional vertex spreads over.
+            stats['cache'].pop(to_fixed(core))
+            test(core)
+            sol = model.getAttr('X', x)
+            result['fractional_cells'] = sum(any(eps < sol[k // 9, k % 9, d] < 1 - eps for d in range(9))
+                                             for k in range(81))
+            fixed = to_fixed(core)
+            result['core'] = ''.join(str(solutions[0][k]) if k in fixed else '.' for k in range(81))
+
+        result['lp_solves'] = stats['lp_solves']
+        result['uniqueness_checks'] = stats['uniqueness_checks']
+        result['time'] = time.perf_counter() - start
+        results[kind] = result
+
+    if model is not None:
+        model.dispose()
+    return(results)
+
+#============================================Driver Code======================================================
+
+if __name__ == '__main__':
+
+    # Data Set 3.
+    files = ["Intermediate Sudokus Correct.txt", "Expert Sudokus Correct.txt"]
+
+    out = open("LP Insufficient Cores.txt", "w")
+    start = time.perf_counter()
+
+    # One process per core; each process builds its own Gurobi models.
+    with multiprocessing.Pool() as pool:
+        for file in files:
+
+            # The puzzle is the first column of the file.
+            f = open(file)
+            puzzles = [line.strip().split(",")[0] for line in f if line.strip()]
+            f.close()
+
+            cores = {'givens': [], 'holes': []}
+            lp_solves = 0
+            uniqueness_checks = 0
+            for puzzle, results in zip(puzzles, pool.imap(find_cores, puzzles)):
+                for kind, result in results.items():
+                    lp_solves += result['lp_solves']
+                    uniqueness_checks += result['uniqueness_checks']
+                    if result['core'] is None:
+                        continue
+                    cores[kind].append((puzzle, result))
+                    givens = sum(c not in '.0' for c in puzzle)
+                    core_givens = sum(c not in '.0' for c in result['core'])
+                    out.write(f"{kind},{result['core']},{puzzle},{core_givens},{givens},{result['lp_solves']},"
+                              f"{result['uniqueness_checks']},{result['fractional_cells']},{result['time']:.3f}\n")
+
+            print(file)
+            print("Number of sudokus:", len(puzzles))
+            print("Number of sudokus with insufficient LP relaxations:", len(cores['givens']))
+            for kind in ('givens', 'holes'):
+                if not cores[kind]:
+                    continue
+                # The size of a givens core is its number of givens, and of a hole core its number of empty cells.
+                sizes = np.array([sum((c in '.0') == (kind == 'holes') for c in r['core']) for p, r in cores[kind]])
+                full = np.array([sum((c in '.0') == (kind == 'holes') for c in p) for p, r in cores[kind]])
+                print(f"Cells in the {kind} cores: mean", sizes.mean(), "min", sizes.min(), "max", sizes.max())
+                print(f"Average fraction of the {kind} of the puzzles kept in the cores:", (sizes / full).mean())
+                print(f"Average fractional cells in the LP of the {kind} cores:",
+                      np.mean([r['fractional_cells'] for p, r in cores[kind]]))
+                print(f"Average time per {kind} core (seconds):", np.mean([r['time'] for p, r in cores[kind]]))
+                print(f"Number of distinct {kind} cores:", len(set(r['core'] for p, r in cores[kind])))
+            print("Total LP solves:", lp_solves, "and uniqueness checks:", uniqueness_checks)
+
+    out.close()
+    print("Total time (seconds):", time.perf_counter() - start)
+    print("Completed.")
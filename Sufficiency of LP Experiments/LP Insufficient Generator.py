@@ -0,0 +1,394 @@
+# Generator of proper sudoku puzzles whose LP relaxation has a fractional solution, to give the sufficiency
+# experiments many more such puzzles than the few found in Data Set 3.
+
+# Every puzzle of the seed file starts a random walk over the clue sets of its solution grid. Each step removes a
+# clue, adds a clue of the solution, or moves a clue to an empty cell, and a step that leaves the puzzle with more
+# than one solution is rejected. A puzzle is kept if the LP of "Linear Programming Problem.py" returns a fractional
+# solution both with presolve on and with presolve off (as in "Turning Off Presolve Test.py"), each on a new model
+# so that the vertex is the one those experiments would see. The walk always moves to a kept puzzle, and to any
+# other proper puzzle with probability explore, so that it stays near the puzzles on which the LP fails.
+
+# Walks often come back to a puzzle they have already tested, for example by adding a clue and removing it again.
+# The result of every puzzle tested by a process (unique or not, and fractional or not) is cached by the puzzle,
+# so that it is never solved twice. Walks run in parallel on a pool of processes, and the cache of each process
+# is shared by every walk it runs.
+
+# The puzzles kept are written to "LP Insufficient Sudokus Correct.txt" in the schema of the "Correct" files of
+# Data Set 3: the puzzle, then the number of givens, singles, hidden singles, naked pairs, hidden pairs, pointing
+# pairs/triples, box/line intersections, guesses and backtracks needed by a human-style solver (see rate). The file
+# can be read by every experiment that runs on Data Set 3, but rate is not the solver that produced the counts of
+# Data Set 3 and applies the techniques in a different order, so its counts are not comparable with those files
+# (it reproduces the stored counts of only 2 of the first 30 Expert puzzles). Experiments that relate LP failure
+# to the techniques needed, such as "Techniques Experiment.py", should not mix the two sources.
+
+# To be run on files within Data Set 3.
+
+import time
+import random
+import multiprocessing
+import gurobipy as gp
+from gurobipy import GRB
+
+# Tolerance below which a value is treated as 0.
+eps = 1e-6
+
+# Number of steps taken from each seed puzzle.
+steps = 200
+
+# Probability of moving to a proper puzzle whose LP is integer.
+explore = 0.3
+
+# The rows, columns and boxes (units) of the 9x9 grid as lists of cell indices, the units each cell belongs to
+# and the peers of each cell (the cells sharing a unit with it).
+units = ([[r*9 + c for c in range(9)] for r in range(9)] +
+         [[r*9 + c for r in range(9)] for c in range(9)] +
+         [[(br*3 + r)*9 + bc*3 + c for r in range(3) for c in range(3)] for br in range(3) for bc in range(3)])
+units_of = [[u for u in units if k in u] for k in range(81)]
+peers = [set(k2 for u in units_of[k] for k2 in u if k2 != k) for k in range(81)]
+boxes = units[18:]
+lines = units[:18]
+
+
+def find_solutions(puzzle,limit):
+    '''
+    Finds up to limit solutions of a puzzle by depth-first search, branching on the cell with the fewest candidates.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+    limit: Number of solutions after which the search stops.
+
+    Outputs:
+    solutions: List of the solutions found, each a string of 81 digits.
+    '''
+    grid = [0 if c in '.0' else int(c) for c in puzzle]
+    for k in range(81):
+        if grid[k] and any(grid[k2] == grid[k] for k2 in peers[k]):
+            return([])
+
+    solutions = []
+
+    def search():
+        best, best_cands = None, None
+        for k in range(81):
+            if grid[k] == 0:
+                cands = set(range(1, 10)) - {grid[k2] for k2 in peers[k]}
+                if best is None or len(cands) < len(best_cands):
+                    best, best_cands = k, cands
+                    if len(cands) <= 1:
+                        break
+        if best is None:
+            solutions.append(''.join(str(d) for d in grid))
+            return
+        for d in sorted(best_cands):
+            grid[best] = d
+            search()
+            grid[best] = 0
+            if len(solutions) >= limit:
+                return
+
+    search()
+    return(solutions)
+
+
+def lp_fractional(puzzle,presolve):
+    '''
+    Solves the LP relaxation of the puzzle on a new model, with presolve on as in "Linear Programming Problem.py"
+    or off as in "Turning Off Presolve Test.py", and determines whether its solution is fractional.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+    presolve: True to leave presolve on, False to turn it off.
+
+    Outputs:
+    True if the LP is feasible and a cell of its solution is not given exactly one digit, False otherwise.
+    '''
+    # Creating an empty model.
+    model = gp.Model('Sudoku Solver')
+
+    # Turns off printing to console.
+    # This line can be commented out if further details about the model are required.
+    model.Params.LogToConsole = 0
+
+    # Turning presolve off.
+    if not presolve:
+        model.Params.Presolve = 0
+
+    # Updates the above parameters of the model.
+    model.update()
+
+    # Defining the decision variables.
+    x = model.addVars(9, 9, 9, vtype=GRB.CONTINUOUS, name='x')
+
+    # Assign givens of the problem to their positions, and with presolve off, bound the remaining positions
+    # by 1 as "Turning Off Presolve Test.py" does.
+    for k in range(81):
+        if puzzle[k] not in '.0':
+            x[k // 9, k % 9, int(puzzle[k]) - 1].lb = 1
+        elif not presolve:
+            for d in range(9):
+                x[k // 9, k % 9, d].ub = 1
+
+    # Only one of each number can be found in a row.
+    model.addConstrs((x.sum(i, '*', k) == 1 for i in range(9) for k in range(9)), name='Row')
+
+    # Only one of each number can be found in a column.
+    model.addConstrs((x.sum('*', j, k) == 1 for j in range(9) for k in range(9)), name='Column')
+
+    # Only one of each number can be found in a box.
+    model.addConstrs((sum(x[i, j, k] for i in range(r*3, (r+1)*3)
+                    for j in range(c*3, (c+1)*3)) == 1 for k in range(9) for r in range(3)
+                    for c in range(3)), name='Box')
+
+    # Each cell within the grid must have a number assigned to it.
+    model.addConstrs((x.sum(i, j, '*') == 1 for i in range(9) for j in range(9)), name='Cell')
+
+    # Since it is a constraint satisfaction (or feasibility) problem, no objective function is required.
+    model.optimize()
+
+    fractional = False
+    if model.status == GRB.Status.OPTIMAL:
+        sol = model.getAttr('X', x)
+        fractional = any(sum(sol[k // 9, k % 9, d] > eps for d in range(9)) != 1 for k in range(81))
+    model.dispose()
+    return(fractional)
+
+
+def rate(puzzle):
+    '''
+    Solves the puzzle as a person would, applying one technique at a time in the order singles, hidden singles,
+    naked pairs, pointing pairs/triples, box/line intersections and hidden pairs, always going back to singles
+    after a technique succeeds, and guessing a digit of a cell with the fewest candidates when none applies.
+    Every application is counted, including those in guesses that are later undone. The counts are of the same
+    kind as those of the "Correct" files, but were not produced by the same solver and do not match them.
+
+    Inputs:
+    puzzle: String of 81 characters with empty cells represented by '.'.
+
+    Outputs:
+    counts: List of the number of givens, singles, hidden singles, naked pairs, hidden pairs, pointing
+            pairs/triples, box/line intersections, guesses and backtracks, as in the "Correct" files.
+    '''
+    counts = {'singles': 0, 'hidden_singles': 0, 'naked_pairs': 0, 'hidden_pairs': 0, 'pointing': 0,
+              'box_line': 0, 'guesses': 0, 'backtracks': 0}
+
+    def remove(cands,cells,digits):
+        # Removes the digits from the cells, returning True if any was there.
+        changed = False
+        for k in cells:
+            if cands[k] & digits:
+                cands[k] -= digits
+                changed = True
+        return(changed)
+
+    def place(cands,placed,k):
+        placed.add(k)
+        remove(cands,peers[k],cands[k])
+
+    def step(cands,placed):
+        # Applies the first technique that changes the candidates. Returns its name, or None if none applies.
+        for k in range(81):
+            if k not in placed and len(cands[k]) == 1:
+                place(cands,placed,k)
+                return('singles')
+        for u in units:
+            for d in range(1, 10):
+                where = [k for k in u if d in cands[k]]
+                if len(where) == 1 and where[0] not in placed:
+                    cands[where[0]] = {d}
+                    place(cands,placed,where[0])
+                    return('hidden_singles')
+        for u in units:
+            pairs = [k for k in u if len(cands[k]) == 2]
+            for a in pairs:
+                for b in pairs:
+                    if a < b and cands[a] == cands[b] and remove(cands,[k for k in u if k not in (a, b)],cands[a]):
+                        return('naked_pairs')
+        for box in boxes:
+            for d in range(1, 10):
+                where = [k for k in box if d in cands[k] and k not in placed]
+                for line in lines:
+                    if where and all(k in line for k in where) and remove(cands,[k for k in line if k not in box],{d}):
+                        return('pointing')
+        for line in lines:
+            for d in range(1, 10):
+                where = [k for k in line if d in cands[k] and k not in placed]
+                for box in boxes:
+                    if where and all(k in box for k in where) and remove(cands,[k for k in box if k not in line],{d}):
+                        return('box_line')
+        for u in units:
+            where = {d: [k for k in u if d in cands[k]] for d in range(1, 10)}
+            twice = [d for d in range(1, 10) if len(where[d]) == 2]
+            for a in twice:
+                for b in twice:
+                    if a < b and where[a] == where[b] and remove(cands,where[a],set(range(1, 10)) - {a, b}):
+                        return('hidden_pairs')
+        return(None)
+
+    def solve(cands,placed):
+        while True:
+            if any(len(c) == 0 for c in cands):
+                return(False)
+            if len(placed) == 81:
+                return(True)
+            technique = step(cands,placed)
+            if technique is None:
+                break
+            counts[technique] += 1
+
+        # Guesses each candidate of a cell with the fewest candidates in turn.
+        k = min((k2 for k2 in range(81) if k2 not in placed), key=lambda k2: len(cands[k2]))
+        for d in sorted(cands[k]):
+            counts['guesses'] += 1
+            child = [set(c) for c in cands]
+            child[k] = {d}
+            child_placed = set(placed)
+            place(child,child_placed,k)
+            if solve(child,child_placed):
+                return(True)
+            counts['backtracks'] += 1
+        return(False)
+
+    cands = [set(range(1, 10)) if c in '.0' else {int(c)} for c in puzzle]
+    placed = set()
+    for k in range(81):
+        if puzzle[k] not in '.0':
+            place(cands,placed,k)
+    solve(cands,placed)
+
+    givens = sum(c not in '.0' for c in puzzle)
+    return([givens] + [counts[key] for key in ('singles', 'hidden_singles', 'naked_pairs', 'hidden_pairs',
+                                                'pointing', 'box_line', 'guesses', 'backtracks')])
+
+
+# Results of the puzzles tested by this process, as (proper, fractional with presolve on and off), by puzzle.
+# Each process of the pool keeps its own cache, shared by every walk it runs.
+cache = {}
+
+
+def test(p,stats):
+    '''
+    Determines whether a puzzle is proper and, if so, whether its LP is fractional with presolve on and off,
+    using the cache of this process if the puzzle has been tested before.
+
+    Inputs:
+    p: String of 81 characters with empty cells represented by '.'.
+    stats: Dictionary of counters, updated with the test.
+
+    Outputs:
+    proper: True if the puzzle has exactly one solution.
+    fractional: True if the puzzle is proper and its LP is fractional with presolve on and off.
+    '''
+    if p in cache:
+        stats['cache_hits'] += 1
+        return(cache[p])
+    stats['tested'] += 1
+    proper = len(find_solutions(p,2)) == 1
+    fractional = False
+    if proper:
+        stats['proper'] += 1
+        stats['lp_solves'] += 1
+        fractional = lp_fractional(p,True)
+        if fractional:
+            stats['lp_solves'] += 1
+            fractional = lp_fractional(p,False)
+    cache[p] = (proper, fractional)
+    return(cache[p])
+
+
+def walk(args):
+    '''
+    Random walk from one seed puzzle. Walks are run on a pool of processes.
+
+    Inputs:
+    args: Tuple (seed puzzle, random seed).
+
+    Outputs:
+    kept: List of the puzzles found whose LP is fractional with presolve on and off, and that no earlier walk
+          of this process has found.
+    stats: Dictionary counting the puzzles tested, found proper and solved by LP, and the cache hits.
+    '''
+    puzzle, seed = args
+    rng = random.Random(seed)
+    stats = {'tested': 0, 'proper': 0, 'lp_solves': 0, 'cache_hits': 0}
+
+    solutions = find_solutions(puzzle,2)
+    if len(solutions) != 1:
+        return([], stats)
+    solution = solutions[0]
+    test(puzzle,stats)
+
+    kept = []
+    current = list(puzzle)
+    for s in range(steps):
+        given = [k for k in range(81) if current[k] not in '.0']
+        empty = [k for k in range(81) if current[k] in '.0']
+        nxt = list(current)
+        move = rng.randrange(3)
+        if move == 0 and len(given) > 17:
+            nxt[rng.choice(given)] = '.'
+        elif move == 1 and empty:
+            k = rng.choice(empty)
+            nxt[k] = solution[k]
+        elif move == 2 and empty:
+            nxt[rng.choice(given)] = '.'
+            k = rng.choice(empty)
+            nxt[k] = solution[k]
+        else:
+            continue
+
+        p = ''.join(nxt)
+        already = p in cache
+        proper, fractional = test(p,stats)
+        if fractional and not already:
+            kept.append(p)
+        if proper and (fractional or rng.random() < explore):
+            current = nxt
+    return(kept, stats)
+
+#============================================Driver Code======================================================
+
+if __name__ == '__main__':
+
+    # Seed puzzles from Data Set 3.
+    file = "Expert Sudokus Correct.txt"
+
+    # Number of puzzles after which generation stops.
+    target = 1000
+
+    f = open(file)
+    seeds = [line.strip().split(",")[0] for line in f if line.strip()]
+    f.close()
+
+    # The seed puzzles are already in Data Set 3, so are not written again.
+    found = set(seeds)
+    written = 0
+
+    out = open("LP Insufficient Sudokus Correct.txt", "w")
+    start = time.perf_counter()
+    totals = {'tested': 0, 'proper': 0, 'lp_solves': 0, 'cache_hits': 0}
+    walks = 0
+
+    # One process per core; each process builds its own Gurobi models and keeps its own cache.
+    with multiprocessing.Pool() as pool:
+        for kept, stats in pool.imap_unordered(walk, [(p, i) for i, p in enumerate(seeds)]):
+            walks += 1
+            for key in totals:
+                totals[key] += stats[key]
+            for p in kept:
+                if p not in found and written < target:
+                    found.add(p)
+                    written += 1
+                    out.write(p + "," + ",".join(str(c) for c in rate(p)) + "\n")
+            if written >= target:
+                pool.terminate()
+                break
+
+    out.close()
+    print("Walks:", walks, "of", steps, "steps from the puzzles of", file)
+    print("Puzzles tested:", totals['tested'], "of which proper:", totals['proper'])
+    print("LP solves:", totals['lp_solves'], "and cache hits:", totals['cache_hits'])
+    print("Proper puzzles with fractional LP solutions with presolve on and off:", written)
+    if totals['proper'] > 0:
+        print("Fraction of the proper puzzles tested that were kept:", written / totals['proper'])
+    print("Time taken (seconds):", time.perf_counter() - start)
+    print("Completed.")